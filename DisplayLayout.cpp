@@ -0,0 +1,365 @@
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <fstream>
+#include <sstream>
+#include <iostream>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+
+// -----------------------------------------------------------------------------
+// Display Layout
+//   One LED panel is 9×16 (mirrored in Firmware/GPUFirmware/GPUFirmware.ino,
+//   whose FRAME_SIZE only fits that size, so layouts reject any other).
+//   A wall is any number of panels tiled into one LED grid; the simulation
+//   domain is sized to the whole grid at CELL_SIZE per LED, centered on x = 0
+//   with y = 0 at the bottom row.
+// -----------------------------------------------------------------------------
+static const int LED_ROWS = 9;
+static const int LED_COLS = 16;
+static const double CELL_SIZE = 0.1;
+
+struct PanelTile {
+    std::string port;   // Serial port of the panel's GPU Arduino
+    int row0, col0;     // Offset of the panel's bottom-left LED in the wall
+    int rows, cols;     // Panel size in LEDs
+};
+
+// Rectangle of LEDs, or a circle in LED units (center at col/row, radius in LEDs)
+struct LedRect { int row0, col0, rows, cols; };
+struct LedCircle { double col, row, radius; };
+
+struct DisplayLayout {
+    int rows, cols;               // Whole wall in LEDs
+    double cellSize;
+    std::string accelPort;
+    std::vector<PanelTile> tiles;
+
+    // Enclosure shape and obstacles, turned into an SDF by buildContainer()
+    std::string containerShape;   // "rect", "ellipse" or "rounded"
+    double containerRadius;       // Corner radius in LEDs for "rounded"
+    std::vector<LedRect> solidCells;
+    std::vector<std::string> solidMask;  // Rows of '.'/'X', top row first
+    std::vector<LedCircle> circles;
+
+    double xMin() const { return -cols * cellSize * 0.5; }
+    double xMax() const { return cols * cellSize * 0.5; }
+    double yMin() const { return 0.0; }
+    double yMax() const { return rows * cellSize; }
+};
+
+// A single 9×16 panel, matching the original fixed setup.
+DisplayLayout defaultDisplayLayout() {
+    DisplayLayout layout;
+    layout.rows = LED_ROWS;
+    layout.cols = LED_COLS;
+    layout.cellSize = CELL_SIZE;
+    layout.accelPort = "COM7";
+    layout.containerShape = "rect";
+    layout.containerRadius = 0.0;
+    PanelTile tile = {"COM6", 0, 0, LED_ROWS, LED_COLS};
+    layout.tiles.push_back(tile);
+    return layout;
+}
+
+// -----------------------------------------------------------------------------
+// Load a layout file. One directive per line, '#' starts a comment:
+//   accel <port>                             accelerometer Arduino
+//   cell <size>                              LED pitch in simulation units
+//   panel <port> <row0> <col0> [rows cols]   one GPU Arduino; the size must be
+//                                            9×16 (GPUFirmware.ino FRAME_SIZE)
+//   container rect|ellipse|rounded <radius>  enclosure shape (default rect)
+//   solid <row0> <col0> [rows cols]          LEDs that are solid obstacles
+//   mask <file>                              bitmap of solid LEDs: one text line
+//                                            per row, top row first, 'X' = solid
+//   circle <col> <row> <radius>              round obstacle, in LED units
+// The wall size is the bounding box of all panels. Returns false (and prints
+// why) on a malformed file or overlapping panels.
+// -----------------------------------------------------------------------------
+bool loadDisplayLayout(const std::string& path, DisplayLayout& layout) {
+    std::ifstream in(path.c_str());
+    if (!in) {
+        std::cerr << "Cannot open layout file " << path << std::endl;
+        return false;
+    }
+
+    layout = DisplayLayout();
+    layout.rows = 0;
+    layout.cols = 0;
+    layout.cellSize = CELL_SIZE;
+    layout.accelPort = "COM7";
+    layout.containerShape = "rect";
+    layout.containerRadius = 0.0;
+
+    std::string line;
+    int lineNo = 0;
+    while (std::getline(in, line)) {
+        lineNo++;
+        size_t hash = line.find('#');
+        if (hash != std::string::npos) line.erase(hash);
+        std::istringstream ls(line);
+        std::string key;
+        if (!(ls >> key)) continue;
+
+        if (key == "accel") {
+            ls >> layout.accelPort;
+        } else if (key == "cell") {
+            ls >> layout.cellSize;
+        } else if (key == "panel") {
+            PanelTile tile;
+            tile.rows = LED_ROWS;
+            tile.cols = LED_COLS;
+            if (!(ls >> tile.port >> tile.row0 >> tile.col0)) {
+                std::cerr << path << ":" << lineNo << ": expected 'panel <port> <row0> <col0> [rows cols]'" << std::endl;
+                return false;
+            }
+            int rows, cols;
+            if (ls >> rows >> cols) {
+                tile.rows = rows;
+                tile.cols = cols;
+            }
+            if (tile.row0 < 0 || tile.col0 < 0) {
+                std::cerr << path << ":" << lineNo << ": panel must have a non-negative offset" << std::endl;
+                return false;
+            }
+            // The GPU firmware only completes frames of exactly one panel
+            if (tile.rows != LED_ROWS || tile.cols != LED_COLS) {
+                std::cerr << path << ":" << lineNo << ": panel is " << tile.rows << "x" << tile.cols
+                          << ", but the GPU firmware drives " << LED_ROWS << "x" << LED_COLS << " panels only" << std::endl;
+                return false;
+            }
+            layout.tiles.push_back(tile);
+        } else if (key == "container") {
+            ls >> layout.containerShape;
+            if (layout.containerShape == "rounded") {
+                if (!(ls >> layout.containerRadius) || layout.containerRadius < 0.0) {
+                    std::cerr << path << ":" << lineNo << ": expected 'container rounded <radius>' with a radius >= 0" << std::endl;
+                    return false;
+                }
+            } else if (layout.containerShape != "rect" && layout.containerShape != "ellipse") {
+                std::cerr << path << ":" << lineNo << ": container must be rect, ellipse or rounded <radius>" << std::endl;
+                return false;
+            }
+        } else if (key == "solid") {
+            LedRect rect = {0, 0, 1, 1};
+            if (!(ls >> rect.row0 >> rect.col0)) {
+                std::cerr << path << ":" << lineNo << ": expected 'solid <row0> <col0> [rows cols]'" << std::endl;
+                return false;
+            }
+            int rows, cols;
+            if (ls >> rows >> cols) {
+                rect.rows = rows;
+                rect.cols = cols;
+            }
+            layout.solidCells.push_back(rect);
+        } else if (key == "mask") {
+            std::string maskPath;
+            ls >> maskPath;
+            std::ifstream maskIn(maskPath.c_str());
+            if (!maskIn) {
+                std::cerr << path << ":" << lineNo << ": cannot open mask " << maskPath << std::endl;
+                return false;
+            }
+            std::string maskLine;
+            layout.solidMask.clear();
+            while (std::getline(maskIn, maskLine)) {
+                if (!maskLine.empty() && maskLine[maskLine.size() - 1] == '\r') maskLine.erase(maskLine.size() - 1);
+                layout.solidMask.push_back(maskLine);
+            }
+        } else if (key == "circle") {
+            LedCircle circle;
+            if (!(ls >> circle.col >> circle.row >> circle.radius)) {
+                std::cerr << path << ":" << lineNo << ": expected 'circle <col> <row> <radius>'" << std::endl;
+                return false;
+            }
+            layout.circles.push_back(circle);
+        } else {
+            std::cerr << path << ":" << lineNo << ": unknown directive '" << key << "'" << std::endl;
+            return false;
+        }
+        if (ls.fail() && !ls.eof()) {
+            std::cerr << path << ":" << lineNo << ": malformed line" << std::endl;
+            return false;
+        }
+    }
+
+    if (layout.tiles.empty() || layout.cellSize <= 0.0) {
+        std::cerr << path << ": layout needs at least one panel and a positive cell size" << std::endl;
+        return false;
+    }
+
+    for (size_t i = 0; i < layout.tiles.size(); i++) {
+        const PanelTile& a = layout.tiles[i];
+        if (a.row0 + a.rows > layout.rows) layout.rows = a.row0 + a.rows;
+        if (a.col0 + a.cols > layout.cols) layout.cols = a.col0 + a.cols;
+        for (size_t j = 0; j < i; j++) {
+            const PanelTile& b = layout.tiles[j];
+            bool overlap = a.row0 < b.row0 + b.rows && b.row0 < a.row0 + a.rows &&
+                           a.col0 < b.col0 + b.cols && b.col0 < a.col0 + a.cols;
+            if (overlap) {
+                std::cerr << path << ": panels on " << a.port << " and " << b.port << " overlap" << std::endl;
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+// -----------------------------------------------------------------------------
+// Solid LEDs of a layout (per-cell rects and the mask file), row-major from
+// the bottom row, 1 = solid.
+// -----------------------------------------------------------------------------
+std::vector<uint8_t> solidLeds(const DisplayLayout& layout) {
+    std::vector<uint8_t> solid(static_cast<size_t>(layout.rows) * layout.cols, 0);
+    for (size_t k = 0; k < layout.solidCells.size(); k++) {
+        const LedRect& rect = layout.solidCells[k];
+        for (int r = rect.row0; r < rect.row0 + rect.rows; r++) {
+            for (int c = rect.col0; c < rect.col0 + rect.cols; c++) {
+                if (r >= 0 && r < layout.rows && c >= 0 && c < layout.cols) {
+                    solid[r * layout.cols + c] = 1;
+                }
+            }
+        }
+    }
+    for (size_t line = 0; line < layout.solidMask.size(); line++) {
+        int r = layout.rows - 1 - static_cast<int>(line);
+        const std::string& text = layout.solidMask[line];
+        for (int c = 0; c < static_cast<int>(text.size()) && c < layout.cols; c++) {
+            if (r >= 0 && (text[c] == 'X' || text[c] == 'x')) {
+                solid[r * layout.cols + c] = 1;
+            }
+        }
+    }
+    return solid;
+}
+
+// -----------------------------------------------------------------------------
+// Build the container SDF for a layout: the enclosure shape around the whole
+// wall, minus solid LEDs (per-cell and mask file) and circular obstacles.
+// -----------------------------------------------------------------------------
+SDFGrid buildContainer(const DisplayLayout& layout) {
+    const double cell = layout.cellSize;
+    const double xmin = layout.xMin(), xmax = layout.xMax();
+    const double ymin = layout.yMin(), ymax = layout.yMax();
+    SDFGrid sdf(xmin, xmax, ymin, ymax, SDF_SPACING, SDF_PAD);
+
+    if (layout.containerShape == "ellipse") {
+        sdf.intersectEllipse(0.5 * (xmin + xmax), 0.5 * (ymin + ymax),
+                             0.5 * (xmax - xmin), 0.5 * (ymax - ymin));
+    } else if (layout.containerShape == "rounded") {
+        sdf.intersectRoundedBox(xmin, xmax, ymin, ymax, layout.containerRadius * cell);
+    } else {
+        sdf.intersectBox(xmin, xmax, ymin, ymax);
+    }
+
+    sdf.subtractMask(solidLeds(layout), layout.rows, layout.cols, xmin, ymin, cell);
+
+    for (size_t k = 0; k < layout.circles.size(); k++) {
+        const LedCircle& circle = layout.circles[k];
+        sdf.subtractCircle(xmin + circle.col * cell, ymin + circle.row * cell, circle.radius * cell);
+    }
+    return sdf;
+}
+
+// -----------------------------------------------------------------------------
+// 64-bit FNV-1a hash of everything buildContainer() reads: wall size, LED
+// pitch, enclosure shape and obstacles. Snapshots record it so a settled
+// state is only reused in the container it settled in.
+// -----------------------------------------------------------------------------
+uint64_t containerHash(const DisplayLayout& layout) {
+    uint64_t hash = 14695981039346656037ull;
+    auto mix = [&hash](const void* data, size_t size) {
+        const uint8_t* bytes = static_cast<const uint8_t*>(data);
+        for (size_t i = 0; i < size; i++) {
+            hash = (hash ^ bytes[i]) * 1099511628211ull;
+        }
+    };
+    mix(&layout.rows, sizeof(layout.rows));
+    mix(&layout.cols, sizeof(layout.cols));
+    mix(&layout.cellSize, sizeof(layout.cellSize));
+    mix(layout.containerShape.data(), layout.containerShape.size() + 1);
+    if (layout.containerShape == "rounded") {
+        mix(&layout.containerRadius, sizeof(layout.containerRadius));
+    }
+    std::vector<uint8_t> solid = solidLeds(layout);
+    mix(solid.data(), solid.size());
+    for (size_t k = 0; k < layout.circles.size(); k++) {
+        mix(&layout.circles[k], sizeof(LedCircle));
+    }
+    return hash;
+}
+
+// -----------------------------------------------------------------------------
+// One persistent worker thread per tile. run(job) calls job(i) for every tile
+// concurrently (tile 0 on the calling thread) and returns once all are done,
+// so the caller can treat each run() as a barrier.
+// -----------------------------------------------------------------------------
+class TileWorkers {
+public:
+    explicit TileWorkers(size_t count)
+        : tileCount(count), generation(0), pending(0), stopping(false), job(nullptr) {
+        for (size_t i = 1; i < tileCount; i++) {
+            threads.emplace_back(&TileWorkers::workerLoop, this, i);
+        }
+    }
+
+    ~TileWorkers() {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopping = true;
+            generation++;
+        }
+        wake.notify_all();
+        for (size_t i = 0; i < threads.size(); i++) {
+            threads[i].join();
+        }
+    }
+
+    void run(const std::function<void(size_t)>& fn) {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            job = &fn;
+            pending = tileCount - 1;
+            generation++;
+        }
+        wake.notify_all();
+
+        if (tileCount > 0) fn(0);
+
+        std::unique_lock<std::mutex> lock(mutex);
+        done.wait(lock, [this] { return pending == 0; });
+        job = nullptr;
+    }
+
+private:
+    void workerLoop(size_t index) {
+        unsigned long seen = 0;
+        while (true) {
+            const std::function<void(size_t)>* fn;
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                wake.wait(lock, [&] { return generation != seen; });
+                seen = generation;
+                if (stopping) return;
+                fn = job;
+            }
+            (*fn)(index);
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                pending--;
+            }
+            done.notify_one();
+        }
+    }
+
+    size_t tileCount;
+    unsigned long generation;
+    size_t pending;
+    bool stopping;
+    const std::function<void(size_t)>* job;
+    std::vector<std::thread> threads;
+    std::mutex mutex;
+    std::condition_variable wake, done;
+};
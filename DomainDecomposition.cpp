@@ -0,0 +1,713 @@
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <cstdio>
+#include <string>
+#include <vector>
+#include <chrono>
+#include <random>
+#include <functional>
+#include <new>
+
+#include <fcntl.h>
+#include <sched.h>
+#include <semaphore.h>
+#include <time.h>
+#include <signal.h>
+#include <sys/mman.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+// -----------------------------------------------------------------------------
+// Domain-decomposed simulation (POSIX only)
+//   The [xmin, xmax] x [ymin, ymax] domain is cut into vertical strips, one per
+//   worker process. Each worker runs its own Simulation on the particles it
+//   owns plus read-only "ghost" copies of its neighbors' particles within
+//   RADIUS of the shared edge. Neighbors talk through single-producer /
+//   single-consumer ring buffers in one POSIX shared-memory segment.
+//
+//   Per step, each worker:
+//     1) integrates its owned particles,
+//     2) migrates owned particles that left its strip to the neighbor,
+//     3) sends positions/velocities of particles near each edge (ghosts),
+//     4) computes density and pressure over owned + ghosts,
+//     5) sends the pressure of the particles it sent as ghosts (a ghost's
+//        density is only complete on its owner),
+//     6) applies pressure and viscosity, then drops the ghosts,
+//     7) every few steps, publishes its particles to a frame slot in the
+//        same segment, where the parent gathers the whole domain.
+//   Pair forces are symmetric, so each side applies its half to the particle
+//   it owns and discards the half that landed on the ghost.
+// -----------------------------------------------------------------------------
+static const int MAX_STRIPS = 64;
+static const size_t HALO_RING_BYTES = 1 << 22;  // Per direction, per neighbor pair
+
+// --- Shared-memory ring buffer ---
+
+struct HaloRingHeader {
+    std::atomic<uint64_t> head;  // Bytes written (producer)
+    char padHead[56];
+    std::atomic<uint64_t> tail;  // Bytes read (consumer)
+    char padTail[56];
+};
+
+class HaloRing {
+public:
+    HaloRing() : header(nullptr), data(nullptr) {}
+    HaloRing(void* base)
+      : header(static_cast<HaloRingHeader*>(base)),
+        data(static_cast<uint8_t*>(base) + sizeof(HaloRingHeader)) {}
+
+    static size_t bytesNeeded() { return sizeof(HaloRingHeader) + HALO_RING_BYTES; }
+
+    // Blocks until there is room. Messages longer than the ring are streamed
+    // through it; since both neighbors send before they receive, one message
+    // must fit in HALO_RING_BYTES or the pair deadlocks.
+    void write(const void* src, size_t len) {
+        const uint8_t* bytes = static_cast<const uint8_t*>(src);
+        uint64_t head = header->head.load(std::memory_order_relaxed);
+        while (len > 0) {
+            uint64_t tail = header->tail.load(std::memory_order_acquire);
+            size_t room = HALO_RING_BYTES - static_cast<size_t>(head - tail);
+            if (room == 0) {
+                sched_yield();
+                continue;
+            }
+            size_t offset = static_cast<size_t>(head % HALO_RING_BYTES);
+            size_t chunk = std::min(std::min(len, room), HALO_RING_BYTES - offset);
+            std::memcpy(data + offset, bytes, chunk);
+            head += chunk;
+            bytes += chunk;
+            len -= chunk;
+            header->head.store(head, std::memory_order_release);
+        }
+    }
+
+    // Blocks until 'len' bytes have been read.
+    void read(void* dst, size_t len) {
+        uint8_t* bytes = static_cast<uint8_t*>(dst);
+        uint64_t tail = header->tail.load(std::memory_order_relaxed);
+        while (len > 0) {
+            uint64_t head = header->head.load(std::memory_order_acquire);
+            size_t avail = static_cast<size_t>(head - tail);
+            if (avail == 0) {
+                sched_yield();
+                continue;
+            }
+            size_t offset = static_cast<size_t>(tail % HALO_RING_BYTES);
+            size_t chunk = std::min(std::min(len, avail), HALO_RING_BYTES - offset);
+            std::memcpy(bytes, data + offset, chunk);
+            tail += chunk;
+            bytes += chunk;
+            len -= chunk;
+            header->tail.store(tail, std::memory_order_release);
+        }
+    }
+
+    template <typename T>
+    void sendMessage(const std::vector<T>& records) {
+        uint32_t count = static_cast<uint32_t>(records.size());
+        write(&count, sizeof(count));
+        if (count) write(records.data(), count * sizeof(T));
+    }
+
+    template <typename T>
+    void receiveMessage(std::vector<T>& records) {
+        uint32_t count;
+        read(&count, sizeof(count));
+        records.resize(count);
+        if (count) read(records.data(), count * sizeof(T));
+    }
+
+private:
+    HaloRingHeader* header;
+    uint8_t* data;
+};
+
+// --- Wire records ---
+
+struct MigrantRecord {  // Full state of a particle changing owner
+    double x, y, px, py, vx, vy, fx, fy, mass;
+};
+struct GhostRecord {    // What a neighbor needs for density and forces
+    double x, y, vx, vy, mass;
+};
+struct GhostPressure {
+    double press, press_near;
+};
+
+// --- Shared control block ---
+
+struct FrameRecord {    // One particle of a published frame
+    double x, y, mass, rho;
+};
+
+struct StripResult {
+    uint64_t particles;   // Owned at the end of the run
+    uint64_t migrated;    // Particles sent to a neighbor
+    uint64_t strayed;     // Migrants received that landed beyond this strip
+    uint64_t ghosts;      // Ghost copies sent to neighbors
+    double minX, maxX, minY, maxY;
+    int nonFinite;        // Particles with NaN/inf positions
+    double seconds;       // Wall time of this worker's steps
+};
+
+// Workers post 'wake' whenever the parent has something to look at (ready,
+// a frame published, done), so the parent sleeps instead of spinning and
+// leaves every core to the workers.
+struct StripControl {
+    std::atomic<int> ready;
+    std::atomic<int> done;
+    std::atomic<int> published;         // Frames published, summed over strips
+    sem_t wake;
+    sem_t start;
+    sem_t frameFree[MAX_STRIPS];        // Posted once the parent has read a strip's frame
+    uint32_t frameCount[MAX_STRIPS];    // Particles in each strip's frame slot
+    int frameStep[MAX_STRIPS];
+    StripResult results[MAX_STRIPS];
+};
+
+// Whole-domain statistics of a final state, for comparing runs whose
+// particles have diverged (the flow is chaotic, so positions can't be
+// compared one to one after more than a few steps)
+static const int HEIGHT_BANDS = 8;
+
+struct DomainStats {
+    double meanX, meanY;                // Center of mass
+    double meanRho;                     // Mass-weighted mean density
+    double heightMass[HEIGHT_BANDS];    // Fraction of the mass per band of height
+};
+
+DomainStats domainStats(const std::vector<FrameRecord>& frame, double ymin, double ymax) {
+    DomainStats stats = {0.0, 0.0, 0.0, {0.0}};
+    double mass = 0.0;
+    for (const FrameRecord& r : frame) {
+        stats.meanX += r.mass * r.x;
+        stats.meanY += r.mass * r.y;
+        stats.meanRho += r.mass * r.rho;
+        int band = static_cast<int>((r.y - ymin) / (ymax - ymin) * HEIGHT_BANDS);
+        stats.heightMass[std::min(std::max(band, 0), HEIGHT_BANDS - 1)] += r.mass;
+        mass += r.mass;
+    }
+    if (mass > 0.0) {
+        stats.meanX /= mass;
+        stats.meanY /= mass;
+        stats.meanRho /= mass;
+        for (int b = 0; b < HEIGHT_BANDS; b++) stats.heightMass[b] /= mass;
+    }
+    return stats;
+}
+
+// Mean of the stats of the frames in the second half of a run; the first
+// half is the initial scatter collapsing
+struct DomainStatsAverage {
+    DomainStats sum = {0.0, 0.0, 0.0, {0.0}};
+    int frames = 0;
+
+    void add(int step, int steps, const DomainStats& stats) {
+        if (2 * (step + 1) < steps) return;
+        sum.meanX += stats.meanX;
+        sum.meanY += stats.meanY;
+        sum.meanRho += stats.meanRho;
+        for (int b = 0; b < HEIGHT_BANDS; b++) sum.heightMass[b] += stats.heightMass[b];
+        frames++;
+    }
+
+    DomainStats mean() const {
+        DomainStats m = sum;
+        if (frames == 0) return m;
+        m.meanX /= frames;
+        m.meanY /= frames;
+        m.meanRho /= frames;
+        for (int b = 0; b < HEIGHT_BANDS; b++) m.heightMass[b] /= frames;
+        return m;
+    }
+};
+
+struct DecompositionReport {
+    int strips;
+    int steps;
+    double seconds;
+    double stepsPerSecond;
+    uint64_t particles;
+    uint64_t migrated;
+    uint64_t strayed;     // Migrants that moved more than one strip in a step
+    uint64_t ghostsPerStep;
+    bool conserved;       // Particle count unchanged and nothing escaped/NaN
+    DomainStats stats;    // Averaged over the published frames of the second half
+};
+
+// Called in the parent with every published frame: the step it was taken
+// after, flattened positions (x0, y0, x1, y1, ...) and masses, in the same
+// form as Simulation::get_visual_positions() and get_masses()
+typedef std::function<void(int step, const std::vector<double>& positions,
+                           const std::vector<double>& masses)> DecompositionFrameFn;
+
+// -----------------------------------------------------------------------------
+// Initial particles of one strip, scattered uniformly over it. Shared by the
+// workers and the single-process reference so both start from the same state.
+// -----------------------------------------------------------------------------
+static void seedStrip(int index, int strips, int count, double xmin, double xmax,
+                      double ymin, double ymax, std::vector<Particle>& particles)
+{
+    const double width = (xmax - xmin) / strips;
+    const double lo = xmin + index * width;
+    const double hi = (index == strips - 1) ? xmax : lo + width;
+    std::mt19937 gen(1234u + index);
+    std::uniform_real_distribution<double> disX(lo, hi), disY(ymin, ymax);
+    int mine = count / strips + (index < count % strips ? 1 : 0);
+    for (int i = 0; i < mine; i++) {
+        double x = disX(gen);
+        double y = disY(gen);
+        particles.emplace_back(x, y);
+    }
+}
+
+// -----------------------------------------------------------------------------
+// One strip worker; runs in its own process.
+// -----------------------------------------------------------------------------
+static void runStrip(int index, int strips, int count, int steps, int frameEvery,
+                     double xmin, double xmax, double ymin, double ymax,
+                     const std::function<double(int)>& gravityAngle,
+                     StripControl* control, FrameRecord* frameSlot,
+                     HaloRing toLeft, HaloRing fromLeft,
+                     HaloRing toRight, HaloRing fromRight)
+{
+    const double width = (xmax - xmin) / strips;
+    const double lo = xmin + index * width;
+    const double hi = (index == strips - 1) ? xmax : lo + width;
+    const bool hasLeft = index > 0;
+    const bool hasRight = index < strips - 1;
+
+    // Owned particles. The container is the whole domain so the outer walls
+    // still apply.
+    Simulation sim(0, xmin, xmax, ymin, ymax);
+    seedStrip(index, strips, count, xmin, xmax, ymin, ymax, sim.particles);
+
+    StripResult& result = control->results[index];
+    result.migrated = 0;
+    result.strayed = 0;
+    result.ghosts = 0;
+
+    std::vector<MigrantRecord> outLeft, outRight, inMigrants;
+    std::vector<GhostRecord> ghostLeft, ghostRight, inGhosts;
+    std::vector<GhostPressure> pressLeft, pressRight, inPress;
+    std::vector<int> leftIdx, rightIdx;
+
+    control->ready.fetch_add(1);
+    sem_post(&control->wake);
+    while (sem_wait(&control->start) != 0) {}
+    auto t0 = std::chrono::steady_clock::now();
+
+    for (int step = 0; step < steps; step++) {
+        // 1) Integrate owned particles
+        sim.integrate(G_MAG, gravityAngle(step));
+
+        // 2) Migration, after integrating so that every owned particle is
+        //    inside the strip when the ghost band is taken
+        outLeft.clear();
+        outRight.clear();
+        for (size_t i = 0; i < sim.particles.size();) {
+            const Particle& p = sim.particles[i];
+            bool goLeft = hasLeft && p.x_pos < lo;
+            bool goRight = hasRight && p.x_pos >= hi;
+            if (goLeft || goRight) {
+                MigrantRecord m = {p.x_pos, p.y_pos, p.previous_x_pos, p.previous_y_pos,
+                                   p.x_vel, p.y_vel, p.x_force, p.y_force, p.mass};
+                (goLeft ? outLeft : outRight).push_back(m);
+                sim.particles[i] = sim.particles.back();
+                sim.particles.pop_back();
+            } else {
+                i++;
+            }
+        }
+        result.migrated += outLeft.size() + outRight.size();
+        if (hasLeft) toLeft.sendMessage(outLeft);
+        if (hasRight) toRight.sendMessage(outRight);
+        for (int side = 0; side < 2; side++) {
+            if (side == 0 ? !hasLeft : !hasRight) continue;
+            (side == 0 ? fromLeft : fromRight).receiveMessage(inMigrants);
+            for (const MigrantRecord& m : inMigrants) {
+                Particle p(m.x, m.y);
+                p.previous_x_pos = m.px;
+                p.previous_y_pos = m.py;
+                p.x_vel = m.vx;
+                p.y_vel = m.vy;
+                p.x_force = m.fx;
+                p.y_force = m.fy;
+                p.mass = m.mass;
+                // Crossed this strip too within one step: its pairs beyond
+                // the ghost band are missed until it migrates on next step
+                if ((hasLeft && m.x < lo) || (hasRight && m.x >= hi)) result.strayed++;
+                sim.particles.push_back(p);
+            }
+        }
+        const size_t owned = sim.particles.size();
+
+        // 3) Ghost positions. Positions don't move again until the next
+        //    integrate, so RADIUS is the whole interaction range.
+        leftIdx.clear();
+        rightIdx.clear();
+        ghostLeft.clear();
+        ghostRight.clear();
+        for (size_t i = 0; i < owned; i++) {
+            const Particle& p = sim.particles[i];
+            GhostRecord g = {p.x_pos, p.y_pos, p.x_vel, p.y_vel, p.mass};
+            if (hasLeft && p.x_pos < lo + RADIUS) {
+                leftIdx.push_back(static_cast<int>(i));
+                ghostLeft.push_back(g);
+            }
+            if (hasRight && p.x_pos >= hi - RADIUS) {
+                rightIdx.push_back(static_cast<int>(i));
+                ghostRight.push_back(g);
+            }
+        }
+        result.ghosts += ghostLeft.size() + ghostRight.size();
+        if (hasLeft) toLeft.sendMessage(ghostLeft);
+        if (hasRight) toRight.sendMessage(ghostRight);
+        size_t leftGhostBegin = owned, rightGhostBegin = owned;
+        for (int side = 0; side < 2; side++) {
+            if (side == 0 ? !hasLeft : !hasRight) continue;
+            (side == 0 ? fromLeft : fromRight).receiveMessage(inGhosts);
+            if (side == 1) rightGhostBegin = sim.particles.size();
+            for (const GhostRecord& g : inGhosts) {
+                Particle p(g.x, g.y);
+                p.x_vel = g.vx;
+                p.y_vel = g.vy;
+                p.mass = g.mass;
+                sim.particles.push_back(p);
+            }
+        }
+
+        // 4) Density and pressure over owned + ghosts
+        sim.calculate_density();
+        sim.calculate_pressures();
+
+        // 5) Ghost pressures from their owners
+        pressLeft.clear();
+        pressRight.clear();
+        for (int i : leftIdx) pressLeft.push_back({sim.particles[i].press, sim.particles[i].press_near});
+        for (int i : rightIdx) pressRight.push_back({sim.particles[i].press, sim.particles[i].press_near});
+        if (hasLeft) toLeft.sendMessage(pressLeft);
+        if (hasRight) toRight.sendMessage(pressRight);
+        for (int side = 0; side < 2; side++) {
+            if (side == 0 ? !hasLeft : !hasRight) continue;
+            (side == 0 ? fromLeft : fromRight).receiveMessage(inPress);
+            size_t begin = (side == 0) ? leftGhostBegin : rightGhostBegin;
+            for (size_t k = 0; k < inPress.size(); k++) {
+                sim.particles[begin + k].press = inPress[k].press;
+                sim.particles[begin + k].press_near = inPress[k].press_near;
+            }
+        }
+
+        // 6) Forces, then drop the ghosts
+        sim.create_pressure();
+        sim.calculate_viscosity();
+        sim.particles.erase(sim.particles.begin() + owned, sim.particles.end());
+
+        // 7) Publish owned particles for the parent (always the last step)
+        if ((frameEvery > 0 && (step + 1) % frameEvery == 0) || step == steps - 1) {
+            while (sem_wait(&control->frameFree[index]) != 0) {}
+            size_t n = std::min(sim.particles.size(), static_cast<size_t>(count));
+            for (size_t i = 0; i < n; i++) {
+                const Particle& p = sim.particles[i];
+                frameSlot[i] = {p.visual_x_pos, p.visual_y_pos, p.mass, p.rho};
+            }
+            control->frameCount[index] = static_cast<uint32_t>(n);
+            control->frameStep[index] = step;
+            control->published.fetch_add(1, std::memory_order_release);
+            sem_post(&control->wake);
+        }
+    }
+    result.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+
+    result.particles = sim.particles.size();
+    result.minX = result.minY = 1e300;
+    result.maxX = result.maxY = -1e300;
+    result.nonFinite = 0;
+    for (const Particle& p : sim.particles) {
+        if (!std::isfinite(p.x_pos) || !std::isfinite(p.y_pos)) {
+            result.nonFinite++;
+            continue;
+        }
+        result.minX = std::min(result.minX, p.x_pos);
+        result.maxX = std::max(result.maxX, p.x_pos);
+        result.minY = std::min(result.minY, p.y_pos);
+        result.maxY = std::max(result.maxY, p.y_pos);
+    }
+    control->done.fetch_add(1);
+    sem_post(&control->wake);
+}
+
+// -----------------------------------------------------------------------------
+// Run 'count' particles for 'steps' steps split over 'strips' worker
+// processes. Blocks until every worker has exited; returns false if one of
+// them dies, after killing the rest, or without starting any if the strips
+// would be narrower than RADIUS. 'onFrame' (optional) gets the whole
+// domain every 'frameEvery' steps; workers wait for it before publishing
+// the next frame, so a slow renderer paces the simulation.
+// -----------------------------------------------------------------------------
+bool runDecomposed(int strips, int count, int steps,
+                   double xmin, double xmax, double ymin, double ymax,
+                   const std::function<double(int)>& gravityAngle,
+                   DecompositionReport& report,
+                   const DecompositionFrameFn& onFrame = DecompositionFrameFn(),
+                   int frameEvery = 1)
+{
+    if (strips < 1 || strips > MAX_STRIPS || count < 1 || steps < 1) return false;
+    // Ghosts and migrants only go to the adjacent strip, so a strip narrower
+    // than the interaction radius would drop pairs spanning two boundaries
+    if ((xmax - xmin) / strips < RADIUS) return false;
+    if (!onFrame) frameEvery = 0;
+
+    // Control block, two rings (one per direction) per neighbor pair, then
+    // one frame slot per strip (any strip may end up owning every particle)
+    const int pairs = strips - 1;
+    size_t controlBytes = (sizeof(StripControl) + 63) & ~static_cast<size_t>(63);
+    size_t ringBytes = 2 * pairs * HaloRing::bytesNeeded();
+    size_t slotBytes = static_cast<size_t>(count) * sizeof(FrameRecord);
+    size_t total = controlBytes + ringBytes + strips * slotBytes;
+
+    std::string name = "/luminousflow_" + std::to_string(getpid());
+    int fd = shm_open(name.c_str(), O_CREAT | O_EXCL | O_RDWR, 0600);
+    if (fd < 0) {
+        std::perror("shm_open");
+        return false;
+    }
+    if (ftruncate(fd, static_cast<off_t>(total)) != 0) {
+        std::perror("ftruncate");
+        close(fd);
+        shm_unlink(name.c_str());
+        return false;
+    }
+    void* base = mmap(NULL, total, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    shm_unlink(name.c_str());  // The mapping stays valid until unmapped
+    if (base == MAP_FAILED) {
+        std::perror("mmap");
+        return false;
+    }
+
+    StripControl* control = new (base) StripControl();
+    control->ready.store(0);
+    control->done.store(0);
+    control->published.store(0);
+    sem_init(&control->wake, 1, 0);
+    sem_init(&control->start, 1, 0);
+    for (int w = 0; w < strips; w++) {
+        sem_init(&control->frameFree[w], 1, 1);
+    }
+    uint8_t* ringBase = static_cast<uint8_t*>(base) + controlBytes;
+    auto ringAt = [&](int pair, int direction) {  // direction 0: left->right, 1: right->left
+        void* at = ringBase + (2 * pair + direction) * HaloRing::bytesNeeded();
+        return HaloRing(at);
+    };
+    for (int r = 0; r < 2 * pairs; r++) {
+        new (ringBase + r * HaloRing::bytesNeeded()) HaloRingHeader();
+        HaloRingHeader* h = reinterpret_cast<HaloRingHeader*>(ringBase + r * HaloRing::bytesNeeded());
+        h->head.store(0);
+        h->tail.store(0);
+    }
+    FrameRecord* frameSlots = reinterpret_cast<FrameRecord*>(ringBase + ringBytes);
+
+    std::vector<pid_t> children;
+    std::vector<char> exited;
+    auto cleanup = [&]() {
+        for (int w = 0; w < strips; w++) sem_destroy(&control->frameFree[w]);
+        sem_destroy(&control->start);
+        sem_destroy(&control->wake);
+        munmap(base, total);
+    };
+    auto killAll = [&]() {
+        for (size_t w = 0; w < children.size(); w++) {
+            if (!exited[w]) kill(children[w], SIGKILL);
+        }
+        for (size_t w = 0; w < children.size(); w++) {
+            if (!exited[w]) waitpid(children[w], NULL, 0);
+        }
+        cleanup();
+    };
+    for (int w = 0; w < strips; w++) {
+        pid_t pid = fork();
+        if (pid < 0) {
+            std::perror("fork");
+            killAll();
+            return false;
+        }
+        if (pid == 0) {
+            HaloRing none;
+            HaloRing toLeft = (w > 0) ? ringAt(w - 1, 1) : none;
+            HaloRing fromLeft = (w > 0) ? ringAt(w - 1, 0) : none;
+            HaloRing toRight = (w < strips - 1) ? ringAt(w, 0) : none;
+            HaloRing fromRight = (w < strips - 1) ? ringAt(w, 1) : none;
+            runStrip(w, strips, count, steps, frameEvery, xmin, xmax, ymin, ymax, gravityAngle,
+                     control, frameSlots + static_cast<size_t>(w) * count,
+                     toLeft, fromLeft, toRight, fromRight);
+            _exit(0);
+        }
+        children.push_back(pid);
+        exited.push_back(0);
+    }
+
+    // Sleep until a worker posts 'wake', checking every 100 ms that none has
+    // died (its neighbors would otherwise block on their rings forever).
+    // Returns false once one has exited abnormally.
+    auto waitForWorkers = [&]() {
+        timespec deadline;
+        clock_gettime(CLOCK_REALTIME, &deadline);
+        deadline.tv_nsec += 100000000L;
+        if (deadline.tv_nsec >= 1000000000L) {
+            deadline.tv_sec++;
+            deadline.tv_nsec -= 1000000000L;
+        }
+        sem_timedwait(&control->wake, &deadline);
+        for (size_t w = 0; w < children.size(); w++) {
+            if (exited[w]) continue;
+            int status = 0;
+            if (waitpid(children[w], &status, WNOHANG) == children[w]) {
+                exited[w] = 1;
+                if (!WIFEXITED(status) || WEXITSTATUS(status) != 0) {
+                    std::fprintf(stderr, "Strip worker %zu died (%s %d)\n", w,
+                                 WIFSIGNALED(status) ? "signal" : "exit status",
+                                 WIFSIGNALED(status) ? WTERMSIG(status) : WEXITSTATUS(status));
+                    return false;
+                }
+            }
+        }
+        return true;
+    };
+
+    while (control->ready.load() < strips) {
+        if (!waitForWorkers()) {
+            killAll();
+            return false;
+        }
+    }
+    for (int w = 0; w < strips; w++) sem_post(&control->start);
+
+    // Collect frames until every worker is done and its last frame is read
+    std::vector<double> positions, masses;
+    std::vector<FrameRecord> frame;
+    DomainStatsAverage average;
+    int framesTaken = 0;
+    while (true) {
+        if (control->published.load(std::memory_order_acquire) >= strips * (framesTaken + 1)) {
+            positions.clear();
+            masses.clear();
+            frame.clear();
+            for (int w = 0; w < strips; w++) {
+                const FrameRecord* slot = frameSlots + static_cast<size_t>(w) * count;
+                frame.insert(frame.end(), slot, slot + control->frameCount[w]);
+            }
+            for (const FrameRecord& r : frame) {
+                positions.push_back(r.x);
+                positions.push_back(r.y);
+                masses.push_back(r.mass);
+            }
+            average.add(control->frameStep[0], steps, domainStats(frame, ymin, ymax));
+            if (onFrame) onFrame(control->frameStep[0], positions, masses);
+            framesTaken++;
+            for (int w = 0; w < strips; w++) sem_post(&control->frameFree[w]);
+            continue;
+        }
+        if (control->done.load() == strips &&
+            control->published.load(std::memory_order_acquire) == strips * framesTaken) {
+            break;
+        }
+        if (!waitForWorkers()) {
+            killAll();
+            return false;
+        }
+    }
+
+    bool exitedCleanly = true;
+    for (size_t w = 0; w < children.size(); w++) {
+        if (exited[w]) continue;
+        int status = 0;
+        waitpid(children[w], &status, 0);
+        exited[w] = 1;
+        if (!WIFEXITED(status) || WEXITSTATUS(status) != 0) exitedCleanly = false;
+    }
+
+    report.strips = strips;
+    report.steps = steps;
+    report.seconds = 0.0;
+    report.particles = 0;
+    report.migrated = 0;
+    report.strayed = 0;
+    uint64_t ghosts = 0;
+    bool inside = true;
+    const double slack = 0.5;  // Soft walls let particles overshoot a little
+    for (int w = 0; w < strips; w++) {
+        const StripResult& r = control->results[w];
+        report.seconds = std::max(report.seconds, r.seconds);
+        report.particles += r.particles;
+        report.migrated += r.migrated;
+        report.strayed += r.strayed;
+        ghosts += r.ghosts;
+        if (r.nonFinite > 0) inside = false;
+        if (r.particles > 0 && (r.minX < xmin - slack || r.maxX > xmax + slack ||
+                                r.minY < ymin - slack || r.maxY > ymax + slack)) {
+            inside = false;
+        }
+    }
+    report.stepsPerSecond = steps / report.seconds;
+    report.ghostsPerStep = ghosts / steps;
+    report.conserved = exitedCleanly && inside && report.particles == static_cast<uint64_t>(count);
+    report.stats = average.mean();
+
+    cleanup();
+    return exitedCleanly;
+}
+
+// -----------------------------------------------------------------------------
+// The same run in one process, with one Simulation over the whole domain and
+// the same initial particles as runDecomposed() with 'strips' strips, as the
+// reference the decomposed runs are checked against. Stats are averaged over
+// the same frames runDecomposed() publishes with 'frameEvery'.
+// -----------------------------------------------------------------------------
+void runSingleProcess(int strips, int count, int steps,
+                      double xmin, double xmax, double ymin, double ymax,
+                      const std::function<double(int)>& gravityAngle,
+                      DecompositionReport& report, int frameEvery = 0)
+{
+    Simulation sim(0, xmin, xmax, ymin, ymax);
+    for (int w = 0; w < strips; w++) {
+        seedStrip(w, strips, count, xmin, xmax, ymin, ymax, sim.particles);
+    }
+
+    // The worker's step sequence (which is update() for the default solver)
+    DomainStatsAverage average;
+    std::vector<FrameRecord> frame;
+    double seconds = 0.0;
+    for (int step = 0; step < steps; step++) {
+        auto t0 = std::chrono::steady_clock::now();
+        sim.integrate(G_MAG, gravityAngle(step));
+        sim.calculate_density();
+        sim.calculate_pressures();
+        sim.create_pressure();
+        sim.calculate_viscosity();
+        seconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+
+        if ((frameEvery > 0 && (step + 1) % frameEvery == 0) || step == steps - 1) {
+            frame.clear();
+            for (const Particle& p : sim.particles) {
+                frame.push_back({p.visual_x_pos, p.visual_y_pos, p.mass, p.rho});
+            }
+            average.add(step, steps, domainStats(frame, ymin, ymax));
+        }
+    }
+
+    report.strips = 1;
+    report.steps = steps;
+    report.seconds = seconds;
+    report.stepsPerSecond = steps / seconds;
+    report.particles = sim.particles.size();
+    report.migrated = 0;
+    report.strayed = 0;
+    report.ghostsPerStep = 0;
+    report.conserved = true;
+    report.stats = average.mean();
+}
@@ -5,11 +5,20 @@
 
 
 // -----------------------------------------------------------------------------
-// Accelerometer Protocol
-//   We'll send 1 header (0xFE) + 8 bytes for 2 floats = 9 bytes total
+// Accelerometer Protocol (v2) - mirrored in TiltProtocol.cpp on the PC side
+//   [0xFE] [version] [2B seq] [4B micros] [4B angle] [4B magnitude] [2B CRC]
+//   = 18 bytes, little-endian. CRC-16/CCITT-FALSE over bytes [1..15].
 // -----------------------------------------------------------------------------
 static const uint8_t ACCEL_HEADER = 0xFE;
-static const int ACCEL_PACKET_SIZE = 9; // 1 + 8
+static const uint8_t ACCEL_VERSION = 0x02;
+static const int ACCEL_PACKET_SIZE = 18;
+
+// Send period. 18 bytes at 115200 baud take ~1.6 ms, so 200 Hz leaves the
+// link mostly idle instead of free-running and filling the PC's buffer.
+static const unsigned long SEND_PERIOD_US = 5000;
+
+static uint16_t packetSeq = 0;
+static unsigned long nextSendMicros = 0;
 
 // -----------------------------------------------------------------------------
 // MPU6050 Accelerometer
@@ -34,33 +43,46 @@ void calculateTilt(float x, float y, float z) {
 }
 
 // -----------------------------------------------------------------------------
-// Send Tilt Data (Binary): [0xFE] [4 bytes angle] [4 bytes magnitude] = 9 bytes
+// CRC-16/CCITT-FALSE (poly 0x1021, init 0xFFFF)
 // -----------------------------------------------------------------------------
-void sendTiltData(float angle, float mag) {
-  // We'll pack floats into a union
-  union FloatBytes {
-    float f;
-    uint8_t b[4];
-  };
-
-  FloatBytes angleData, magData;
-  angleData.f = angle;
-  magData.f   = mag;
+uint16_t tiltCrc16(const uint8_t* data, int len) {
+  uint16_t crc = 0xFFFF;
+  for (int i = 0; i < len; i++) {
+    crc ^= (uint16_t)data[i] << 8;
+    for (int b = 0; b < 8; b++) {
+      crc = (crc & 0x8000) ? (crc << 1) ^ 0x1021 : (crc << 1);
+    }
+  }
+  return crc;
+}
 
+// -----------------------------------------------------------------------------
+// Send Tilt Data (Binary): see protocol layout above
+// -----------------------------------------------------------------------------
+void sendTiltData(unsigned long sampleMicros, float angle, float mag) {
   uint8_t packet[ACCEL_PACKET_SIZE];
   packet[0] = ACCEL_HEADER; // 0xFE
+  packet[1] = ACCEL_VERSION;
+
+  // sequence number
+  packet[2] = packetSeq & 0xFF;
+  packet[3] = packetSeq >> 8;
+  packetSeq++;
 
-  // copy angle
-  packet[1] = angleData.b[0];
-  packet[2] = angleData.b[1];
-  packet[3] = angleData.b[2];
-  packet[4] = angleData.b[3];
+  // sensor timestamp
+  uint32_t ts = (uint32_t)sampleMicros;
+  packet[4] = ts & 0xFF;
+  packet[5] = (ts >> 8) & 0xFF;
+  packet[6] = (ts >> 16) & 0xFF;
+  packet[7] = (ts >> 24) & 0xFF;
 
-  // copy magnitude
-  packet[5] = magData.b[0];
-  packet[6] = magData.b[1];
-  packet[7] = magData.b[2];
-  packet[8] = magData.b[3];
+  // angle and magnitude (AVR floats are little-endian IEEE-754, same as the PC)
+  memcpy(&packet[8], &angle, 4);
+  memcpy(&packet[12], &mag, 4);
+
+  uint16_t crc = tiltCrc16(&packet[1], ACCEL_PACKET_SIZE - 3);
+  packet[16] = crc & 0xFF;
+  packet[17] = crc >> 8;
 
   Serial.write(packet, ACCEL_PACKET_SIZE);
 }
@@ -82,22 +104,29 @@ void setup() {
   mpu.setAccelerometerRange(MPU6050_RANGE_8_G);
   mpu.setGyroRange(MPU6050_RANGE_500_DEG);
   mpu.setFilterBandwidth(MPU6050_BAND_21_HZ);
+
+  nextSendMicros = micros();
 }
 
 // -----------------------------------------------------------------------------
 // Loop
 // -----------------------------------------------------------------------------
 void loop() {
+  // Pace output to a fixed rate
+  unsigned long now = micros();
+  if ((long)(now - nextSendMicros) < 0) {
+    return;
+  }
+  nextSendMicros += SEND_PERIOD_US;
+  if ((long)(now - nextSendMicros) > (long)SEND_PERIOD_US) {
+    // Fell far behind (e.g. I2C stall); don't burst to catch up
+    nextSendMicros = now + SEND_PERIOD_US;
+  }
+
   sensors_event_t accel, gyro, temp;
   if (mpu.getEvent(&accel, &gyro, &temp)) {
-//  Serial.print("Gyro X: "); Serial.print(accel.acceleration.x);
-//  Serial.print(" Y: "); Serial.print(accel.acceleration.y);
-//  Serial.print(" Z: "); Serial.println(accel.acceleration.z);
-//  Serial.print(" tilt: "); Serial.println(tiltAngle);
-//  Serial.print(" mag: "); Serial.println(tiltMagnitude);
-//  delay(1000);
+    unsigned long sampleMicros = micros();
     calculateTilt(accel.acceleration.x, accel.acceleration.y, accel.acceleration.z);
-    sendTiltData(tiltAngle, tiltMagnitude);
-    };
-
+    sendTiltData(sampleMicros, tiltAngle, tiltMagnitude);
+  }
 }
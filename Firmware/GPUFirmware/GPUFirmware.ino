@@ -10,8 +10,12 @@
 // For receiving the new binary protocol: 1 header + 144 brightness bytes = 145
 #define LED_ROWS 9   // 9 total rows
 #define LED_COLS 16  // 16 total columns (8 per half)
-#define FRAME_SIZE  (1 + LED_ROWS * LED_COLS)  // 145
+#define FRAME_SIZE  (1 + LED_ROWS * LED_COLS)  // 145; the host's layout loader
+                                                // rejects panels of any other size
 #define FRAME_HEADER 0xFF
+// A received frame is only shown once this byte arrives, so every panel of a
+// multi-panel wall can be told to swap at the same moment (no tearing)
+#define FRAME_COMMIT 0xFD
 
 //----------------------------------------------------------
 // Charlie-Plex Mapping Array
@@ -160,40 +164,57 @@ void refreshFrame(Pixel frameArray[][ROWS][COLS]) {
 // We'll buffer 145 bytes: 1 header (0xFF) + 144 brightness bytes
 static uint8_t serialBuffer[FRAME_SIZE];
 static int bufferIndex = 0;
+// True when serialBuffer holds a complete frame waiting for FRAME_COMMIT
+static bool framePending = false;
+
+// Copies the buffered brightness data into our global 'frame'
+void applyPendingFrame() {
+  int offset = 1; // skip the 0xFF header
+
+  for (int row = 0; row < LED_ROWS; row++) {
+    for (int col = 0; col < LED_COLS; col++) {
+      uint8_t brightness = serialBuffer[offset++];
+      
+      // Figure out which half (0 or 1), and the column within that half
+      int half = (col < COLS) ? 0 : 1;
+      int colInHalf = (half == 0) ? col : (col - COLS);
+
+      // Update the Pixel object
+      frame[half][row][colInHalf].a = brightness;
+    }
+  }
+}
 
 // Reads new frames from Serial (if available)
 void parseSerial() {
   while (Serial.available()) {
     uint8_t incoming = Serial.read();
 
-    // If this is the first byte in a potential frame, we expect 0xFF
-    if (bufferIndex == 0 && incoming != FRAME_HEADER) {
-      // Not the correct header, ignore and keep waiting
-      continue;
+    if (bufferIndex == 0) {
+      // Between frames: show the buffered frame on commit
+      if (incoming == FRAME_COMMIT) {
+        if (framePending) {
+          applyPendingFrame();
+          framePending = false;
+        }
+        continue;
+      }
+      // Otherwise we expect 0xFF to start a frame
+      if (incoming != FRAME_HEADER) {
+        // Not the correct header, ignore and keep waiting
+        continue;
+      }
+      // A new frame replaces one that was never committed
+      framePending = false;
     }
 
     // Store the incoming byte
     serialBuffer[bufferIndex++] = incoming;
 
-    // If we've collected all 145 bytes, we have a complete frame
+    // If we've collected all 145 bytes, we have a complete frame; hold it
+    // until the PC commits it
     if (bufferIndex == FRAME_SIZE) {
-      // Decode the brightness data into our global 'frame'
-      int offset = 1; // skip the 0xFF header
-
-      for (int row = 0; row < LED_ROWS; row++) {
-        for (int col = 0; col < LED_COLS; col++) {
-          uint8_t brightness = serialBuffer[offset++];
-          
-          // Figure out which half (0 or 1), and the column within that half
-          int half = (col < COLS) ? 0 : 1;
-          int colInHalf = (half == 0) ? col : (col - COLS);
-
-          // Update the Pixel object
-          frame[half][row][colInHalf].a = brightness;
-        }
-      }
-
-      // Done reading this frame
+      framePending = true;
       bufferIndex = 0;
     }
   }
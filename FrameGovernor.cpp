@@ -0,0 +1,96 @@
+#include <cstdint>
+#include <algorithm>
+
+// -----------------------------------------------------------------------------
+// Frame-budget governor
+//   Watches how long each physics step takes against a budget and trades
+//   quality for time when the machine is loaded, one level at a time:
+//     level 1     viscosity every other step
+//     level 2     + neighbor lists capped at GOVERNOR_NEIGHBOR_CAP
+//     level 3..8  + particle count reduced to 90%..40% by merging neighbors
+//   Merged particles carry the combined mass, and the rasterizer weights by
+//   mass, so the amount of lit "fluid" on the LEDs stays the same. When there
+//   is headroom again, levels step back down and particles are split.
+// -----------------------------------------------------------------------------
+static const int GOVERNOR_MAX_LEVEL = 8;
+static const int GOVERNOR_NEIGHBOR_CAP = 8;
+static const double GOVERNOR_MAX_MERGE_MASS = 4.0;
+static const double GOVERNOR_EMA = 0.1;         // Smoothing of the step time
+static const double GOVERNOR_HEADROOM = 0.6;    // Step down below 60% of budget
+static const int GOVERNOR_HOLD_STEPS = 30;      // Minimum steps between level changes
+static const double GOVERNOR_RATE = 0.02;       // Max fraction of particles merged/split per step
+
+struct GovernorMetrics {
+    double budgetMs;
+    double stepMsEma;
+    int level;
+    int particles;
+    int targetParticles;
+    double totalMass;
+    uint64_t merges;
+    uint64_t splits;
+    uint64_t overBudgetSteps;
+    uint64_t levelChanges;
+};
+
+class FrameGovernor {
+public:
+    FrameGovernor(double budgetMs, int fullCount)
+      : fullParticles(fullCount), stepsSinceChange(0)
+    {
+        m.budgetMs = budgetMs;
+        m.stepMsEma = 0.0;
+        m.level = 0;
+        m.particles = fullCount;
+        m.targetParticles = fullCount;
+        m.totalMass = fullCount;
+        m.merges = 0;
+        m.splits = 0;
+        m.overBudgetSteps = 0;
+        m.levelChanges = 0;
+    }
+
+    // Call once after every physics step with how long it took.
+    void update(double stepMs, Simulation& sim) {
+        m.stepMsEma = (m.stepMsEma == 0.0) ? stepMs : m.stepMsEma + GOVERNOR_EMA * (stepMs - m.stepMsEma);
+        if (stepMs > m.budgetMs) m.overBudgetSteps++;
+        stepsSinceChange++;
+
+        int level = m.level;
+        if (m.stepMsEma > m.budgetMs && level < GOVERNOR_MAX_LEVEL &&
+            stepsSinceChange >= GOVERNOR_HOLD_STEPS) {
+            level++;
+        } else if (m.stepMsEma < m.budgetMs * GOVERNOR_HEADROOM && level > 0 &&
+                   stepsSinceChange >= 2 * GOVERNOR_HOLD_STEPS) {
+            level--;
+        }
+        if (level != m.level) {
+            m.level = level;
+            m.levelChanges++;
+            stepsSinceChange = 0;
+        }
+
+        sim.viscosity_interval = (m.level >= 1) ? 2 : 1;
+        sim.max_neighbors = (m.level >= 2) ? GOVERNOR_NEIGHBOR_CAP : 0;
+
+        // Move the particle count toward the level's target, a little per step
+        double fraction = 1.0 - 0.1 * std::max(0, m.level - 2);
+        m.targetParticles = static_cast<int>(fullParticles * fraction);
+        int count = sim.particles.size();
+        int rate = std::max(1, static_cast<int>(count * GOVERNOR_RATE));
+        if (count > m.targetParticles) {
+            m.merges += sim.merge_particles(std::min(rate, count - m.targetParticles), GOVERNOR_MAX_MERGE_MASS);
+        } else if (count < m.targetParticles) {
+            m.splits += sim.split_particles(std::min(rate, m.targetParticles - count));
+        }
+        m.particles = sim.particles.size();
+        m.totalMass = sim.total_mass();
+    }
+
+    const GovernorMetrics& metrics() const { return m; }
+
+private:
+    int fullParticles;
+    int stepsSinceChange;
+    GovernorMetrics m;
+};
@@ -0,0 +1,252 @@
+#include <chrono>
+#include <cstdint>
+#include <cmath>
+#include <algorithm>
+
+// -----------------------------------------------------------------------------
+// Motion-to-photon latency instrumentation
+//
+// Every tilt sample is stamped when the sensor took it (mapped from the
+// Arduino's micros() onto the PC clock) and when the PC parsed it. Every
+// frame is stamped at each pipeline stage. The age of the tilt that produced
+// a frame, measured when the frame has been handed to the serial port, goes
+// into a histogram.
+// -----------------------------------------------------------------------------
+typedef std::chrono::steady_clock LatencyClock;
+typedef LatencyClock::time_point LatencyTime;
+
+static inline double microsBetween(LatencyTime from, LatencyTime to) {
+    return std::chrono::duration<double, std::micro>(to - from).count();
+}
+
+struct TiltStamp {
+    LatencyTime sampled;   // Sensor time, mapped onto the PC clock
+    LatencyTime received;  // When the parser produced the packet
+};
+
+struct FrameStamp {
+    TiltStamp tilt;        // Tilt that drove the latest physics step
+    LatencyTime simStart;
+    LatencyTime simDone;
+    LatencyTime rasterDone;
+    LatencyTime sendDone;
+};
+
+// -----------------------------------------------------------------------------
+// Log-linear histogram of microsecond latencies: 8 sub-buckets per power of
+// two, covering 1 us .. ~4.3 s. Recording is O(1) and allocation-free.
+// -----------------------------------------------------------------------------
+class LatencyHistogram {
+public:
+    static const int SUB_BUCKETS = 8;
+    static const int OCTAVES = 32;
+    static const int BUCKETS = SUB_BUCKETS * OCTAVES;
+
+    LatencyHistogram() { reset(); }
+
+    void reset() {
+        for (int i = 0; i < BUCKETS; i++) counts[i] = 0;
+        total = 0;
+        maxMicros = 0.0;
+        sumMicros = 0.0;
+    }
+
+    void record(double micros) {
+        if (micros < 0.0) micros = 0.0;
+        counts[bucketFor(micros)]++;
+        total++;
+        sumMicros += micros;
+        if (micros > maxMicros) maxMicros = micros;
+    }
+
+    // Upper edge of the bucket holding the p-th percentile (p in [0, 100]).
+    double percentile(double p) const {
+        if (total == 0) return 0.0;
+        uint64_t rank = static_cast<uint64_t>(std::ceil(p / 100.0 * total));
+        if (rank == 0) rank = 1;
+        uint64_t seen = 0;
+        for (int i = 0; i < BUCKETS; i++) {
+            seen += counts[i];
+            if (seen >= rank) {
+                double edge = bucketUpperEdge(i);
+                return edge < maxMicros ? edge : maxMicros;
+            }
+        }
+        return maxMicros;
+    }
+
+    uint64_t count() const { return total; }
+    double mean() const { return total ? sumMicros / total : 0.0; }
+    double max() const { return maxMicros; }
+    uint64_t bucketCount(int i) const { return counts[i]; }
+    static double bucketUpperEdge(int i) {
+        int octave = i / SUB_BUCKETS;
+        int sub = i % SUB_BUCKETS;
+        return std::ldexp(1.0 + (sub + 1) / static_cast<double>(SUB_BUCKETS), octave);
+    }
+
+private:
+    static int bucketFor(double micros) {
+        if (micros < 1.0) return 0;
+        int exp;
+        double frac = std::frexp(micros, &exp);  // micros = frac * 2^exp, frac in [0.5, 1)
+        int octave = exp - 1;
+        if (octave >= OCTAVES) return BUCKETS - 1;
+        int sub = static_cast<int>((frac * 2.0 - 1.0) * SUB_BUCKETS);
+        return octave * SUB_BUCKETS + sub;
+    }
+
+    uint64_t counts[BUCKETS];
+    uint64_t total;
+    double maxMicros;
+    double sumMicros;
+};
+
+// -----------------------------------------------------------------------------
+// Maps the sensor's 32-bit micros() onto the PC clock. The fastest transport
+// is the smallest (receive - sensor); that offset drifts because the two
+// crystals don't run at exactly the same rate, so it is tracked as a line:
+// the minimum of each WINDOW_US of sensor time is kept for the last WINDOWS
+// windows, and offset plus skew are fitted through those minima. Any extra
+// transport delay then shows up as latency. The sensor clock wraps every ~71
+// minutes, so timestamps are unwrapped first.
+// -----------------------------------------------------------------------------
+class SensorClock {
+public:
+    static constexpr double WINDOW_US = 2e6;  // One minimum per 2 s of sensor time
+    static const int WINDOWS = 30;            // Fit over the last minute
+
+    SensorClock()
+        : haveSample(false), lastRaw(0), wraps(0), windowStart(0.0),
+          windowSensor(0.0), windowMin(0.0), closed(0), next(0),
+          fitSlope(0.0), fitIntercept(0.0), epoch(LatencyClock::now()) {}
+
+    LatencyTime toHost(uint32_t sensorMicros, LatencyTime received) {
+        if (haveSample && sensorMicros < lastRaw && lastRaw - sensorMicros > 0x80000000u) {
+            wraps++;
+        }
+        lastRaw = sensorMicros;
+        double sensor = static_cast<double>(sensorMicros) + wraps * 4294967296.0;
+        double host = microsBetween(epoch, received);
+        double offset = host - sensor;
+
+        if (!haveSample) {
+            startWindow(sensor, offset);
+            haveSample = true;
+        } else if (sensor - windowStart >= WINDOW_US) {
+            closeWindow();
+            startWindow(sensor, offset);
+        } else if (offset < windowMin) {
+            windowMin = offset;
+            windowSensor = sensor;
+        }
+
+        // The open window's minimum, carried along the fitted skew, wins if
+        // the link just got faster than the line predicts
+        double mapped = sensor + std::min(offsetAt(sensor),
+                                          windowMin + fitSlope * (sensor - windowSensor));
+        if (mapped > host) mapped = host;
+        return epoch + std::chrono::duration_cast<LatencyClock::duration>(
+                           std::chrono::duration<double, std::micro>(mapped));
+    }
+
+    // Sensor clock rate relative to the PC, in parts per million (positive
+    // when the sensor runs slow).
+    double skewPpm() const { return fitSlope * 1e6; }
+
+private:
+    void startWindow(double sensor, double offset) {
+        windowStart = sensor;
+        windowSensor = sensor;
+        windowMin = offset;
+    }
+
+    // Store the finished window's minimum and refit the line by least squares
+    void closeWindow() {
+        minSensor[next] = windowSensor;
+        minOffset[next] = windowMin;
+        next = (next + 1) % WINDOWS;
+        if (closed < WINDOWS) closed++;
+
+        double meanX = 0.0, meanY = 0.0;
+        for (int i = 0; i < closed; i++) {
+            meanX += minSensor[i];
+            meanY += minOffset[i];
+        }
+        meanX /= closed;
+        meanY /= closed;
+        double sxx = 0.0, sxy = 0.0;
+        for (int i = 0; i < closed; i++) {
+            sxx += (minSensor[i] - meanX) * (minSensor[i] - meanX);
+            sxy += (minSensor[i] - meanX) * (minOffset[i] - meanY);
+        }
+        fitSlope = (sxx > 0.0) ? sxy / sxx : 0.0;
+        fitIntercept = meanY - fitSlope * meanX;
+    }
+
+    double offsetAt(double sensor) const {
+        if (closed == 0) return windowMin;
+        return fitIntercept + fitSlope * sensor;
+    }
+
+    bool haveSample;
+    uint32_t lastRaw;
+    uint64_t wraps;
+    double windowStart;    // Sensor time the open window started
+    double windowSensor;   // Sensor time of the open window's minimum
+    double windowMin;      // Smallest (host - sensor) in the open window
+    double minSensor[WINDOWS];
+    double minOffset[WINDOWS];
+    int closed;            // Closed windows held in minSensor/minOffset
+    int next;              // Ring slot the next closed window goes into
+    double fitSlope;
+    double fitIntercept;
+    LatencyTime epoch;
+};
+
+// -----------------------------------------------------------------------------
+// Gravity-direction predictor. Tracks the tilt angle's rate of change and
+// extrapolates it to the time the frame is expected to reach the LEDs, so a
+// fast tilt isn't shown where the board was one pipeline-latency ago.
+// -----------------------------------------------------------------------------
+class GravityPredictor {
+public:
+    static constexpr double RATE_SMOOTHING = 0.3;     // EMA weight of the newest rate
+    static constexpr double MAX_HORIZON_US = 100000.0; // Never extrapolate past 100 ms
+    static constexpr double MAX_RATE_DEG_PER_US = 2e-3; // 2000 deg/s
+
+    GravityPredictor() : haveSample(false), lastAngleDeg(0.0), rateDegPerUs(0.0) {}
+
+    void addSample(LatencyTime sampled, double angleDeg) {
+        if (haveSample) {
+            double dt = microsBetween(lastSampled, sampled);
+            if (dt > 0.0) {
+                double delta = std::remainder(angleDeg - lastAngleDeg, 360.0);
+                double rate = delta / dt;
+                rateDegPerUs += RATE_SMOOTHING * (rate - rateDegPerUs);
+                if (rateDegPerUs > MAX_RATE_DEG_PER_US) rateDegPerUs = MAX_RATE_DEG_PER_US;
+                if (rateDegPerUs < -MAX_RATE_DEG_PER_US) rateDegPerUs = -MAX_RATE_DEG_PER_US;
+            }
+        }
+        haveSample = true;
+        lastSampled = sampled;
+        lastAngleDeg = angleDeg;
+    }
+
+    // Predicted tilt angle (degrees) at 'displayTime'.
+    double predict(LatencyTime displayTime) const {
+        if (!haveSample) return 0.0;
+        double horizon = microsBetween(lastSampled, displayTime);
+        if (horizon < 0.0) horizon = 0.0;
+        if (horizon > MAX_HORIZON_US) horizon = MAX_HORIZON_US;
+        return lastAngleDeg + rateDegPerUs * horizon;
+    }
+
+    double rateDegPerSec() const { return rateDegPerUs * 1e6; }
+
+private:
+    bool haveSample;
+    LatencyTime lastSampled;
+    double lastAngleDeg;
+    double rateDegPerUs;
+};
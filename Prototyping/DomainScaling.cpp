@@ -0,0 +1,136 @@
+// Scaling report for the domain-decomposed simulation in DomainDecomposition.cpp.
+// Runs the same particle count on 1, 2, 4, ... worker processes on this box.
+//   g++ -O2 -std=c++17 -pthread Prototyping/DomainScaling.cpp -o DomainScaling -lrt
+//   ./DomainScaling [particles] [steps] [max strips]
+// Each decomposed run is checked against runSingleProcess() from the same
+// initial particles: with one strip the state must be identical, with more
+// the flow has diverged particle by particle, so the center of mass, mean
+// density and height profile (averaged over the second half of the run)
+// must agree within the tolerances below.
+// Frames gathered from the workers must hold every particle, a worker that
+// dies mid-run must make runDecomposed() fail instead of hanging, and strips
+// narrower than RADIUS must be refused. 'strayed' counts migrants that
+// crossed more than one strip in a step (particles flung off a wall); they
+// move on at the next step and miss some pairs for that one step.
+#include <iostream>
+#include <iomanip>
+#include <cstdlib>
+#include <thread>
+
+#include "../SPHEngine.cpp"
+#include "../DomainDecomposition.cpp"
+
+static const double CENTER_TOLERANCE = 0.02;   // Of the domain size
+static const double DENSITY_TOLERANCE = 0.03;  // Relative
+static const double PROFILE_TOLERANCE = 0.10;  // Summed |mass fraction| over height bands
+static const int FRAME_EVERY = 10;
+
+static bool statsMatch(const DomainStats& a, const DomainStats& b, double width, double height,
+                       double& profileError) {
+    profileError = 0.0;
+    for (int k = 0; k < HEIGHT_BANDS; k++) profileError += std::fabs(a.heightMass[k] - b.heightMass[k]);
+    return std::fabs(a.meanX - b.meanX) < CENTER_TOLERANCE * width &&
+           std::fabs(a.meanY - b.meanY) < CENTER_TOLERANCE * height &&
+           std::fabs(a.meanRho - b.meanRho) < DENSITY_TOLERANCE * b.meanRho &&
+           profileError < PROFILE_TOLERANCE;
+}
+
+int main(int argc, char** argv) {
+    int particles = (argc > 1) ? std::atoi(argv[1]) : 4000;
+    int steps = (argc > 2) ? std::atoi(argv[2]) : 600;
+    int maxStrips = (argc > 3) ? std::atoi(argv[3]) : 8;
+
+    // A wall 4 panels wide, 1 tall; gravity sloshes left and right
+    const double xmin = -3.2, xmax = 3.2, ymin = 0.0, ymax = 0.9;
+    std::function<double(int)> gravity = [](int step) {
+        return G_ANG + 0.6 * std::sin(step * 0.02);
+    };
+
+    std::cout << particles << " particles, " << steps << " steps, "
+              << std::thread::hardware_concurrency() << " hardware threads\n\n";
+    std::cout << std::setw(7) << "strips" << std::setw(12) << "steps/s" << std::setw(10) << "speedup"
+              << std::setw(12) << "efficiency" << std::setw(12) << "ghosts/st" << std::setw(10) << "migrated"
+              << std::setw(11) << "conserved" << std::setw(9) << "strayed" << std::setw(9) << "dRho%" << std::setw(9) << "profile"
+              << std::setw(8) << "match" << "\n";
+
+    double baseline = 0.0;
+    bool allGood = true;
+    for (int strips = 1; strips <= maxStrips; strips *= 2) {
+        // Every FRAME_EVERY steps the whole domain arrives here, as it would
+        // at a renderer
+        int frames = 0;
+        bool framesComplete = true;
+        DecompositionFrameFn onFrame = [&](int, const std::vector<double>& positions,
+                                           const std::vector<double>& masses) {
+            frames++;
+            if (positions.size() != 2 * masses.size() || masses.size() != static_cast<size_t>(particles)) {
+                framesComplete = false;
+            }
+        };
+        DecompositionReport report, reference;
+        if (!runDecomposed(strips, particles, steps, xmin, xmax, ymin, ymax, gravity, report,
+                           onFrame, FRAME_EVERY)) {
+            std::cerr << "Run with " << strips << " strips failed\n";
+            return 1;
+        }
+        runSingleProcess(strips, particles, steps, xmin, xmax, ymin, ymax, gravity, reference, FRAME_EVERY);
+
+        double profileError = 0.0;
+        bool match = statsMatch(report.stats, reference.stats, xmax - xmin, ymax - ymin, profileError);
+        if (strips == 1) {
+            // No halos: the worker runs exactly the reference's steps
+            match = match && report.stats.meanX == reference.stats.meanX &&
+                    report.stats.meanY == reference.stats.meanY &&
+                    report.stats.meanRho == reference.stats.meanRho;
+            baseline = report.stepsPerSecond;
+        }
+        bool good = report.conserved && match && framesComplete && frames == (steps + FRAME_EVERY - 1) / FRAME_EVERY;
+
+        double speedup = report.stepsPerSecond / baseline;
+        std::cout << std::fixed << std::setprecision(2)
+                  << std::setw(7) << strips << std::setw(12) << report.stepsPerSecond
+                  << std::setw(10) << speedup << std::setw(12) << speedup / strips
+                  << std::setw(12) << report.ghostsPerStep << std::setw(10) << report.migrated
+                  << std::setw(11) << (report.conserved ? "yes" : "NO")
+                  << std::setw(9) << report.strayed
+                  << std::setw(9) << 100.0 * (report.stats.meanRho / reference.stats.meanRho - 1.0)
+                  << std::setw(9) << profileError
+                  << std::setw(8) << (match ? "yes" : "NO");
+        if (!framesComplete || frames != (steps + FRAME_EVERY - 1) / FRAME_EVERY) {
+            std::cout << "  (" << frames << " frames, incomplete)";
+        }
+        std::cout << "\n";
+        allGood = allGood && good;
+    }
+
+    // One worker is killed mid-run; its neighbors would block on their rings
+    // forever, so the parent has to notice and give up
+    int* crashed = static_cast<int*>(mmap(NULL, sizeof(int), PROT_READ | PROT_WRITE,
+                                          MAP_SHARED | MAP_ANONYMOUS, -1, 0));
+    *crashed = 0;
+    std::function<double(int)> crashing = [&](int step) {
+        if (step == steps / 2 && __sync_fetch_and_add(crashed, 1) == 0) raise(SIGKILL);
+        return gravity(step);
+    };
+    DecompositionReport crashReport;
+    auto t0 = std::chrono::steady_clock::now();
+    bool crashFailed = !runDecomposed(std::min(4, maxStrips), particles, steps, xmin, xmax, ymin, ymax,
+                                      crashing, crashReport);
+    double crashSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+    std::cout << "\nWorker killed mid-run: " << (crashFailed ? "detected" : "NOT detected")
+              << " after " << std::setprecision(2) << crashSeconds << " s\n";
+    munmap(crashed, sizeof(int));
+    allGood = allGood && crashFailed;
+
+    // Strips narrower than the interaction radius would lose pairs that span
+    // two boundaries
+    int tooMany = static_cast<int>((xmax - xmin) / RADIUS) + 1;
+    DecompositionReport narrowReport;
+    bool narrowRefused = tooMany > MAX_STRIPS ||
+        !runDecomposed(tooMany, particles, steps, xmin, xmax, ymin, ymax, gravity, narrowReport);
+    std::cout << tooMany << " strips (" << std::setprecision(3) << (xmax - xmin) / tooMany
+              << " wide, RADIUS " << RADIUS << "): " << (narrowRefused ? "refused" : "NOT refused") << "\n";
+    allGood = allGood && narrowRefused;
+
+    return allGood ? 0 : 1;
+}
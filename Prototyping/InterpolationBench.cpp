@@ -0,0 +1,144 @@
+// CPU cost and smoothness per displayed frame: one physics step per frame (the
+// default in main.cpp) against fixed-rate physics (--physics-hz), showing
+// either the latest state or frames interpolated in between. Frames are paced
+// in virtual time at the serial transport rate, so only the CPU work is
+// measured.
+//   g++ -O2 -std=c++17 Prototyping/InterpolationBench.cpp -o InterpolationBench
+//   ./InterpolationBench [seconds] [particles per panel]
+// The fixed-rate modes scale dt to their step rate, as main.cpp does, so they
+// run the same seconds of fluid motion and the CPU per frame compares equal
+// simulated time. Step/frame runs at dt 1, as main.cpp does when stepping
+// once per packet, which is DISPLAY_HZ / REFERENCE_STEP_HZ of that motion
+// (1.4% less). Double-density relaxation diverges above dt 1, so rates below
+// REFERENCE_STEP_HZ use the position-based solver.
+//   Frame delta is the mean |brightness change| per LED between frames: about
+// the same for every mode, since the fluid moves as far. Jitter is its
+// standard deviation over frames: showing the latest state of a slower
+// physics rate repeats frames and then jumps, and interpolation should take
+// that back down to the step-per-frame level.
+#include <iostream>
+#include <iomanip>
+#include <cstdlib>
+#include <ctime>
+#include <cstdint>
+#include <string>
+
+#include "../SPHEngine.cpp"
+#include "../DisplayLayout.cpp"
+#include "../Rasterizer.cpp"
+
+// 115200 baud, 10 bits per byte, 145-byte frame + 1 commit byte
+static const double DISPLAY_HZ = 115200.0 / 10.0 / (1 + LED_ROWS * LED_COLS + 1);
+// Steps per second at dt 1; must match REFERENCE_STEP_HZ in main.cpp
+static const double REFERENCE_STEP_HZ = 80.0;
+static const double SETTLE_UNITS = 300.0;
+
+struct BenchResult {
+    double cpuMsPerFrame;
+    double stepsPerFrame;
+    double meanFrameDelta;  // Mean |brightness change| per LED between frames
+    double frameJitter;     // Its standard deviation over frames
+};
+
+// physicsHz == 0: step once per frame and show the latest state
+BenchResult runMode(Solver solver, double physicsHz, bool interpolate, double seconds, int particles) {
+    DisplayLayout layout = defaultDisplayLayout();
+    Simulation sim(particles, layout.xMin(), layout.xMax(), layout.yMin(), layout.yMax());
+    sim.solver = solver;
+    sim.dt = (physicsHz > 0.0) ? REFERENCE_STEP_HZ / physicsHz : 1.0;
+    // Settle first so every mode starts from a resting pool
+    for (int i = 0; i < static_cast<int>(SETTLE_UNITS / sim.dt); i++) sim.update(G_MAG, G_ANG);
+
+    const PanelTile& tile = layout.tiles[0];
+    std::vector<unsigned char> frame(tile.rows * tile.cols), lastFrame(frame.size(), 0);
+    std::vector<double> positions, masses, ledCounts;
+
+    const int frames = static_cast<int>(seconds * DISPLAY_HZ);
+    const double framePeriod = 1.0 / DISPLAY_HZ;
+    const double physicsPeriod = (physicsHz > 0.0) ? 1.0 / physicsHz : 0.0;
+    double accum = 0.0;
+    long steps = 0;
+    double deltaSum = 0.0, deltaSqSum = 0.0;
+
+    std::clock_t start = std::clock();
+    for (int f = 0; f < frames; f++) {
+        // Slow side-to-side tilt, in terms of display time
+        double t = f * framePeriod;
+        double angle = G_ANG + 0.6 * std::sin(t * 1.5);
+
+        if (physicsPeriod == 0.0) {
+            sim.update(G_MAG, angle);
+            steps++;
+            positions = sim.get_visual_positions();
+        } else {
+            accum += framePeriod;
+            while (accum >= physicsPeriod) {
+                sim.update(G_MAG, angle);
+                accum -= physicsPeriod;
+                steps++;
+            }
+            sim.get_interpolated_positions(interpolate ? accum / physicsPeriod : 1.0, positions);
+        }
+        binParticles(positions, masses, layout, ledCounts);
+        hashGrid(ledCounts, layout, tile, frame.data());
+
+        if (f > 0) {
+            double delta = 0.0;
+            for (size_t i = 0; i < frame.size(); i++) {
+                delta += std::abs(static_cast<int>(frame[i]) - static_cast<int>(lastFrame[i]));
+            }
+            delta /= frame.size();
+            deltaSum += delta;
+            deltaSqSum += delta * delta;
+        }
+        lastFrame.swap(frame);
+    }
+    double cpuSeconds = static_cast<double>(std::clock() - start) / CLOCKS_PER_SEC;
+
+    BenchResult result;
+    result.cpuMsPerFrame = cpuSeconds * 1000.0 / frames;
+    result.stepsPerFrame = static_cast<double>(steps) / frames;
+    result.meanFrameDelta = deltaSum / (frames - 1);
+    result.frameJitter = std::sqrt(std::max(0.0, deltaSqSum / (frames - 1) -
+                                                  result.meanFrameDelta * result.meanFrameDelta));
+    return result;
+}
+
+int main(int argc, char** argv) {
+    double seconds = (argc > 1) ? std::atof(argv[1]) : 10.0;
+    int particles = (argc > 2) ? std::atoi(argv[2]) : 250;
+
+    std::cout << particles << " particles, " << seconds << " s of frames at "
+              << std::fixed << std::setprecision(1) << DISPLAY_HZ << " Hz\n\n";
+    std::cout << std::setw(22) << "mode" << std::setw(6) << "dt" << std::setw(14) << "CPU ms/frame"
+              << std::setw(10) << "vs dd" << std::setw(13) << "steps/frame" << std::setw(14) << "frame delta"
+              << std::setw(10) << "jitter" << "\n";
+
+    struct Mode { const char* solverName; Solver solver; double hz; bool interpolate; };
+    const Mode modes[] = {
+        {"dd", Solver::DoubleDensity, 0.0, false},
+        {"dd", Solver::DoubleDensity, REFERENCE_STEP_HZ, true},
+        {"pbf", Solver::PositionBased, 0.0, false},
+        {"pbf", Solver::PositionBased, 40.0, false},
+        {"pbf", Solver::PositionBased, 40.0, true},
+        {"pbf", Solver::PositionBased, 20.0, false},
+        {"pbf", Solver::PositionBased, 20.0, true},
+    };
+    double baseline = 0.0;
+    for (const Mode& m : modes) {
+        BenchResult r = runMode(m.solver, m.hz, m.interpolate, seconds, particles);
+        if (baseline == 0.0) baseline = r.cpuMsPerFrame;
+        std::string mode = std::string(m.solverName) + " " +
+            ((m.hz == 0.0) ? std::string("step/frame")
+                           : std::to_string(static_cast<int>(m.hz)) + " Hz " + (m.interpolate ? "interp" : "latest"));
+        double dt = (m.hz > 0.0) ? REFERENCE_STEP_HZ / m.hz : 1.0;
+        std::cout << std::setw(22) << mode << std::setprecision(2) << std::setw(6) << dt << std::setprecision(3)
+                  << std::setw(14) << r.cpuMsPerFrame << std::setprecision(2) << std::setw(9)
+                  << r.cpuMsPerFrame / baseline << "x" << std::setprecision(3) << std::setw(13) << r.stepsPerFrame
+                  << std::setw(14) << r.meanFrameDelta << std::setw(10) << r.frameJitter << "\n";
+    }
+    std::cout << "\nStep/frame runs at dt 1 and so covers " << std::setprecision(1)
+              << 100.0 * (1.0 - DISPLAY_HZ / REFERENCE_STEP_HZ)
+              << "% less simulated time than the fixed-rate modes.\n";
+    return 0;
+}
@@ -0,0 +1,61 @@
+// Sensor-to-PC clock mapping test for SensorClock in Latency.cpp.
+//   g++ -O2 -std=c++17 Prototyping/LatencyClockTest.cpp -o LatencyClockTest
+// Simulates 10 minutes of tilt packets at 200 Hz over a link with a fixed
+// 2 ms floor plus random queueing delay and occasional stalls, with the
+// sensor crystal running slow, fast or exact. The mapped sample time can
+// only be known up to the fastest transport, so the reported latency must
+// equal the true transport minus that floor, within TOLERANCE_US, for the
+// whole run once two closed windows have given a skew.
+#include <iostream>
+#include <iomanip>
+#include <random>
+
+#include "../Latency.cpp"
+
+static const double RATE_HZ = 200.0;
+static const double RUN_SECONDS = 600.0;
+static const double FLOOR_US = 2000.0;
+static const double TOLERANCE_US = 500.0;
+
+static bool run(const char* name, double skewPpm, uint32_t sensorStart, unsigned seed) {
+    std::mt19937 rng(seed);
+    std::exponential_distribution<double> queueing(1.0 / 800.0);  // Mean 0.8 ms
+    std::uniform_int_distribution<int> pct(0, 99);
+
+    SensorClock clock;
+    LatencyTime base = LatencyClock::now();
+    double worstError = 0.0, lastReported = 0.0;
+    const int samples = static_cast<int>(RUN_SECONDS * RATE_HZ);
+    for (int i = 0; i < samples; i++) {
+        double hostSampled = i * 1e6 / RATE_HZ;
+        // A slow sensor counts fewer microseconds per real one
+        uint32_t sensorMicros = sensorStart + static_cast<uint32_t>(
+            static_cast<uint64_t>(hostSampled * (1.0 - skewPpm * 1e-6)));
+        double transport = FLOOR_US + queueing(rng);
+        if (pct(rng) < 1) transport += 30000.0;  // USB stall
+        LatencyTime received = base + std::chrono::duration_cast<LatencyClock::duration>(
+                                          std::chrono::duration<double, std::micro>(hostSampled + transport));
+
+        double reported = microsBetween(clock.toHost(sensorMicros, received), received);
+        if (hostSampled < 3 * SensorClock::WINDOW_US) continue;  // Skew needs two closed windows
+        double error = std::fabs(reported - (transport - FLOOR_US));
+        if (error > worstError) worstError = error;
+        lastReported = reported;
+    }
+
+    bool ok = worstError < TOLERANCE_US;
+    std::cout << std::setw(14) << name << std::fixed << std::setprecision(0)
+              << std::setw(10) << skewPpm << " ppm  fitted " << std::setw(6) << clock.skewPpm()
+              << " ppm  worst error " << std::setw(6) << worstError << " us  last "
+              << std::setw(6) << lastReported << " us  " << (ok ? "ok" : "FAIL") << "\n";
+    return ok;
+}
+
+int main() {
+    int failures = 0;
+    if (!run("exact", 0.0, 0, 1)) failures++;
+    if (!run("slow sensor", 1000.0, 0, 2)) failures++;   // 0.1% slow
+    if (!run("fast sensor", -1000.0, 0, 3)) failures++;
+    if (!run("slow, wraps", 1000.0, 0xFFFFFFFFu - 60000000u, 4)) failures++;  // micros() wraps after 60 s
+    return failures == 0 ? 0 : 1;
+}
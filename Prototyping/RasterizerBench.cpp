@@ -0,0 +1,103 @@
+// hashGrid() against kernelDensity() (Rasterizer.cpp): cost per frame and
+// temporal stability, on the same particle positions, for a few particle
+// counts. Flicker counts LEDs that jump one way and straight back (both
+// changes above FLICKER_STEP) as a fraction of all LED updates.
+//   g++ -O2 -std=c++17 Prototyping/RasterizerBench.cpp -o RasterizerBench
+//   ./RasterizerBench [frames]
+#include <iostream>
+#include <iomanip>
+#include <cstdlib>
+#include <chrono>
+
+#include "../SPHEngine.cpp"
+#include "../DisplayLayout.cpp"
+#include "../Rasterizer.cpp"
+
+static const int FLICKER_STEP = 16;
+
+struct StabilityStats {
+    double rasterMicros = 0.0;
+    double deltaSum = 0.0;
+    long flickers = 0;
+    long updates = 0;
+    std::vector<int> last, lastDelta;
+
+    void record(const std::vector<unsigned char>& frame) {
+        if (last.empty()) {
+            last.assign(frame.begin(), frame.end());
+            lastDelta.assign(frame.size(), 0);
+            return;
+        }
+        for (size_t i = 0; i < frame.size(); i++) {
+            int delta = frame[i] - last[i];
+            deltaSum += std::abs(delta);
+            if (std::abs(delta) > FLICKER_STEP && std::abs(lastDelta[i]) > FLICKER_STEP &&
+                (delta > 0) != (lastDelta[i] > 0)) {
+                flickers++;
+            }
+            updates++;
+            last[i] = frame[i];
+            lastDelta[i] = delta;
+        }
+    }
+};
+
+int main(int argc, char** argv) {
+    int frames = (argc > 1) ? std::atoi(argv[1]) : 2000;
+    DisplayLayout layout = defaultDisplayLayout();
+    const PanelTile& tile = layout.tiles[0];
+    typedef std::chrono::steady_clock Clock;
+
+    std::cout << frames << " frames, one physics step each, slow tilt\n\n";
+    std::cout << std::setw(10) << "particles" << std::setw(12) << "step ms"
+              << std::setw(12) << "raster" << std::setw(14) << "us/frame"
+              << std::setw(14) << "mean |delta|" << std::setw(10) << "flicker" << "\n";
+
+    const int counts[] = {250, 180, 120};
+    for (int count : counts) {
+        Simulation sim(count, layout.xMin(), layout.xMax(), layout.yMin(), layout.yMax());
+        for (int i = 0; i < 300; i++) sim.update(G_MAG, G_ANG);
+
+        std::vector<unsigned char> frame(tile.rows * tile.cols);
+        std::vector<double> masses, ledCounts;
+        NeighborGrid grid(layout.xMin(), layout.xMax(), layout.yMin(), layout.yMax(), RADIUS);
+        StabilityStats hash, kde;
+        double stepMicros = 0.0;
+
+        for (int f = 0; f < frames; f++) {
+            double angle = G_ANG + 0.6 * std::sin(f * 0.01);
+            auto t0 = Clock::now();
+            sim.update(G_MAG, angle);
+            auto t1 = Clock::now();
+            stepMicros += std::chrono::duration<double, std::micro>(t1 - t0).count();
+            std::vector<double> positions = sim.get_visual_positions();
+
+            t0 = Clock::now();
+            binParticles(positions, masses, layout, ledCounts);
+            hashGrid(ledCounts, layout, tile, frame.data());
+            t1 = Clock::now();
+            hash.rasterMicros += std::chrono::duration<double, std::micro>(t1 - t0).count();
+            hash.record(frame);
+
+            t0 = Clock::now();
+            grid.build(positions);
+            kernelDensity(positions, masses, grid, layout, tile, frame.data());
+            t1 = Clock::now();
+            kde.rasterMicros += std::chrono::duration<double, std::micro>(t1 - t0).count();
+            kde.record(frame);
+        }
+
+        const StabilityStats* stats[] = {&hash, &kde};
+        const char* names[] = {"hashGrid", "kernel"};
+        for (int k = 0; k < 2; k++) {
+            const StabilityStats& s = *stats[k];
+            std::cout << std::fixed << std::setw(10) << count
+                      << std::setprecision(3) << std::setw(12) << stepMicros / frames / 1000.0
+                      << std::setw(12) << names[k]
+                      << std::setprecision(2) << std::setw(14) << s.rasterMicros / frames
+                      << std::setw(14) << s.deltaSum / s.updates
+                      << std::setprecision(4) << std::setw(10) << static_cast<double>(s.flickers) / s.updates << "\n";
+        }
+    }
+    return 0;
+}
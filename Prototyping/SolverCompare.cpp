@@ -0,0 +1,248 @@
+// Double-density relaxation against position-based fluids (SPHEngine.cpp):
+// replays a tilt trace at a range of step lengths and reports the largest
+// stable dt of each solver, and what that means in physics steps per second
+// and CPU time per second of motion.
+//   g++ -O2 -std=c++17 Prototyping/SolverCompare.cpp -o SolverCompare
+//   ./SolverCompare [trace file] [particles]
+// The trace comes from main.cpp --record-tilt (one line per physics step:
+// seconds, gravity angle in radians, and that step's dt; traces without the
+// dt column are taken as dt = 1). It is resampled onto dt = 1 units, so a
+// trace recorded at --physics-hz 20 (dt 4) replays at its real speed. Without one, a synthetic trace
+// at SYNTHETIC_RATE steps/s is used: a hold, slow rocking, sharp flips and a
+// shake.
+//   A run is stable when nothing becomes NaN, no particle gets more than
+// MAX_PENETRATION into a wall (the double-density walls are springs, so some
+// penetration is normal) and the fluid settles after the trace (RMS speed
+// under SETTLED_RMS). It matches when it also settles to about the same depth
+// as the reference run (double-density at dt = 1), within DEPTH_TOLERANCE.
+// The summary takes the largest dt up to which every run is both, and its CPU
+// time per second of motion against double-density's. Pass a larger particle
+// count for a deeper pool: the position-based solver needs more iterations or
+// a smaller dt the deeper the fluid.
+#include <iostream>
+#include <iomanip>
+#include <fstream>
+#include <sstream>
+#include <chrono>
+#include <cstdlib>
+#include <algorithm>
+
+#include "../SPHEngine.cpp"
+
+static const double SYNTHETIC_RATE = 80.0;   // Steps per second (about one per frame)
+static const double SETTLE_UNITS = 600.0;    // Gravity-down hold after the trace
+static const double SETTLED_RMS = 0.002;     // Per unit of time
+static const double DEPTH_TOLERANCE = 0.1;   // Relative to the reference depth
+static const double MAX_PENETRATION = 2.0 * RADIUS;
+
+struct TiltTrace {
+    std::vector<double> angle;  // Per step at dt = 1
+    double stepsPerSecond;
+
+    // Angle at time t (in dt = 1 steps), linearly interpolated
+    double at(double t) const {
+        if (t <= 0.0) return angle.front();
+        size_t k = static_cast<size_t>(t);
+        if (k + 1 >= angle.size()) return angle.back();
+        double f = t - k;
+        return angle[k] + f * (angle[k + 1] - angle[k]);
+    }
+};
+
+bool loadTrace(const std::string& path, TiltTrace& trace) {
+    std::ifstream in(path.c_str());
+    if (!in) return false;
+    std::string line;
+    double first = -1.0, last = 0.0;
+    std::vector<double> units, angles;  // Simulated time (dt = 1 steps) at each line
+    double unitsNow = 0.0;
+    while (std::getline(in, line)) {
+        if (line.empty() || line[0] == '#') continue;
+        std::istringstream ls(line);
+        double seconds, angle, dt;
+        if (!(ls >> seconds >> angle)) continue;
+        if (!(ls >> dt) || dt <= 0.0) dt = 1.0;
+        if (first < 0.0) first = seconds;
+        last = seconds;
+        units.push_back(unitsNow);
+        angles.push_back(angle);
+        unitsNow += dt;
+    }
+    if (angles.size() < 2 || last <= first) return false;
+
+    // One angle per dt = 1 step, linear between the recorded steps
+    size_t k = 0;
+    for (double t = 0.0; t <= units.back(); t += 1.0) {
+        while (k + 2 < units.size() && units[k + 1] <= t) k++;
+        double f = (t - units[k]) / (units[k + 1] - units[k]);
+        trace.angle.push_back(angles[k] + std::min(f, 1.0) * (angles[k + 1] - angles[k]));
+    }
+    trace.stepsPerSecond = units.back() / (last - first);
+    return trace.angle.size() >= 2;
+}
+
+TiltTrace syntheticTrace() {
+    TiltTrace trace;
+    trace.stepsPerSecond = SYNTHETIC_RATE;
+    const int seconds = 30;
+    for (int k = 0; k < seconds * SYNTHETIC_RATE; k++) {
+        double t = k / SYNTHETIC_RATE;
+        double a = G_ANG;
+        if (t < 3) {
+            a = G_ANG;                                      // Hold
+        } else if (t < 13) {
+            a = G_ANG + 0.8 * std::sin((t - 3) * 1.2);     // Slow rocking
+        } else if (t < 21) {
+            a = G_ANG + ((static_cast<int>(t - 13) % 2) ? 1.2 : -1.2);  // Sharp flips every second
+        } else if (t < 26) {
+            a = G_ANG + 0.4 * std::sin((t - 21) * 25.0);   // Shake
+        }
+        trace.angle.push_back(a);
+    }
+    return trace;
+}
+
+struct RunResult {
+    bool finite;
+    double maxPenetration;
+    double settledRms;
+    double depth;        // 95th percentile height after settling
+    double msPerStep;
+};
+
+RunResult runTrace(const TiltTrace& trace, Solver solver, int iterations, double dt, int particles) {
+    Simulation sim(0, -SIM_W, SIM_W, BOTTOM, TOP);
+    sim.solver = solver;
+    sim.solver_iterations = iterations;
+    sim.dt = dt;
+    // Same starting particles for every run
+    std::mt19937 gen(1);
+    std::uniform_real_distribution<double> dis_x(-SIM_W, SIM_W), dis_y(BOTTOM, TOP);
+    for (int i = 0; i < particles; i++) {
+        sim.particles.emplace_back(dis_x(gen), dis_y(gen));
+    }
+
+    RunResult r = {true, 0.0, 0.0, 0.0, 0.0};
+    const double traceUnits = static_cast<double>(trace.angle.size());
+    const double totalUnits = SETTLE_UNITS + traceUnits + SETTLE_UNITS;
+    const int steps = static_cast<int>(std::ceil(totalUnits / dt));
+    const int rmsFrom = static_cast<int>((totalUnits - 100.0) / dt);
+    double rmsSum = 0.0;
+    long rmsCount = 0;
+
+    auto start = std::chrono::steady_clock::now();
+    for (int k = 0; k < steps && r.finite; k++) {
+        // Settle, replay the trace, settle again
+        double t = k * dt - SETTLE_UNITS;
+        double angle = (t < 0.0 || t >= traceUnits) ? G_ANG : trace.at(t);
+        sim.update(G_MAG, angle);
+
+        for (const auto &p : sim.particles) {
+            if (!std::isfinite(p.x_pos) || !std::isfinite(p.y_pos)) {
+                r.finite = false;
+                break;
+            }
+            double nx, ny;
+            r.maxPenetration = std::max(r.maxPenetration, -sim.container.sample(p.x_pos, p.y_pos, nx, ny));
+            if (k >= rmsFrom) {
+                rmsSum += p.x_vel * p.x_vel + p.y_vel * p.y_vel;
+                rmsCount++;
+            }
+        }
+    }
+    auto end = std::chrono::steady_clock::now();
+    r.msPerStep = std::chrono::duration<double, std::milli>(end - start).count() / steps;
+    if (!r.finite) return r;
+
+    r.settledRms = std::sqrt(rmsSum / std::max(rmsCount, 1L));
+    std::vector<double> heights;
+    for (const auto &p : sim.particles) heights.push_back(p.y_pos);
+    std::sort(heights.begin(), heights.end());
+    r.depth = heights[heights.size() * 95 / 100];
+    return r;
+}
+
+int main(int argc, char** argv) {
+    TiltTrace trace;
+    std::string source = "synthetic trace";
+    if (argc > 1 && std::string(argv[1]) != "-") {
+        if (!loadTrace(argv[1], trace)) {
+            std::cerr << "Cannot read tilt trace " << argv[1] << std::endl;
+            return 1;
+        }
+        source = argv[1];
+    } else {
+        trace = syntheticTrace();
+    }
+    int particles = (argc > 2) ? std::atoi(argv[2]) : 250;
+
+    std::cout << source << ": " << trace.angle.size() << " steps at "
+              << std::fixed << std::setprecision(1) << trace.stepsPerSecond << " steps/s, "
+              << particles << " particles\n\n";
+
+    RunResult reference = runTrace(trace, Solver::DoubleDensity, 1, 1.0, particles);
+    if (!reference.finite) {
+        std::cerr << "Reference run (double-density, dt 1) blew up" << std::endl;
+        return 1;
+    }
+
+    struct Config { const char* name; Solver solver; int iterations; };
+    const Config configs[] = {
+        {"double-density", Solver::DoubleDensity, 1},
+        {"pbf x4", Solver::PositionBased, 4},
+        {"pbf x8", Solver::PositionBased, 8},
+    };
+    const double dts[] = {1.0, 1.5, 2.0, 3.0, 4.0, 5.0, 6.0};
+
+    std::cout << std::setw(16) << "solver" << std::setw(6) << "dt" << std::setw(10) << "ms/step"
+              << std::setw(10) << "depth" << std::setw(12) << "settle rms" << std::setw(11) << "max pen"
+              << std::setw(9) << "stable" << std::setw(8) << "match" << "\n";
+
+    std::vector<std::string> summary;
+    double referenceMs = 0.0;  // CPU per second of motion, double-density
+    for (const Config& config : configs) {
+        double bestDt = 0.0, bestMs = 0.0;
+        bool contiguous = true;
+        for (double dt : dts) {
+            RunResult r = runTrace(trace, config.solver, config.iterations, dt, particles);
+            bool stable = r.finite && r.maxPenetration < MAX_PENETRATION && r.settledRms < SETTLED_RMS;
+            bool match = stable && std::fabs(r.depth - reference.depth) < DEPTH_TOLERANCE * reference.depth;
+            std::cout << std::setw(16) << config.name << std::setprecision(1) << std::setw(6) << dt
+                      << std::setprecision(3) << std::setw(10) << r.msPerStep;
+            if (r.finite) {
+                std::cout << std::setw(10) << r.depth << std::setw(12) << std::scientific << std::setprecision(1)
+                          << r.settledRms << std::fixed << std::setprecision(3) << std::setw(11) << r.maxPenetration;
+            } else {
+                std::cout << std::setw(33) << "diverged";
+            }
+            std::cout << std::setw(9) << (stable ? "yes" : "no") << std::setw(8) << (match ? "yes" : "no") << "\n";
+            contiguous = contiguous && match;
+            if (contiguous) {
+                bestDt = dt;
+                bestMs = r.msPerStep;
+            }
+        }
+
+        std::ostringstream line;
+        line << std::fixed << std::setw(16) << config.name;
+        if (bestDt == 0.0) {
+            line << "  no stable, matching dt";
+        } else {
+            double stepsPerSecond = trace.stepsPerSecond / bestDt;
+            line << std::setprecision(1) << "  dt " << std::setw(4) << bestDt
+                 << "  needs " << std::setw(6) << stepsPerSecond << " steps/s"
+                 << "  = " << std::setprecision(2) << std::setw(6) << stepsPerSecond * bestMs
+                 << " ms CPU per second of motion";
+            if (config.solver == Solver::DoubleDensity) {
+                referenceMs = stepsPerSecond * bestMs;
+            } else if (referenceMs > 0.0) {
+                line << "  (x" << stepsPerSecond * bestMs / referenceMs << " double-density)";
+            }
+        }
+        summary.push_back(line.str());
+    }
+
+    std::cout << "\nLargest stable, matching dt (reference depth " << std::setprecision(3) << reference.depth << "):\n";
+    for (const std::string& line : summary) std::cout << line << "\n";
+    return 0;
+}
@@ -0,0 +1,169 @@
+// Fuzz + throughput test for the accelerometer packet parser in TiltProtocol.cpp.
+//   g++ -O2 -std=c++17 Prototyping/TiltParserTest.cpp -o TiltParserTest
+#include <iostream>
+#include <vector>
+#include <deque>
+#include <random>
+#include <chrono>
+#include <cstring>
+
+#include "../TiltProtocol.cpp"
+
+static bool sameSample(const TiltSample& a, const TiltSample& b) {
+    return a.seq == b.seq && a.sensorMicros == b.sensorMicros &&
+           std::memcmp(&a.angleDeg, &b.angleDeg, 4) == 0 &&
+           std::memcmp(&a.magnitude, &b.magnitude, 4) == 0;
+}
+
+// Build a damaged stream: packets are dropped, bit-flipped, truncated and
+// interleaved with garbage. Payloads deliberately contain 0xFE bytes. The
+// stream is then fed to the parser in random-sized chunks, and every packet
+// it returns must be one of the intact packets, in order. A 16-bit CRC lets
+// roughly 1 in 65536 damaged candidates through; those "ghosts" are counted
+// and bounded in main() instead of failing the seed outright.
+static bool fuzz(unsigned seed, int packets, uint64_t& ghosts, uint64_t& corrupt) {
+    std::mt19937 rng(seed);
+    std::uniform_int_distribution<int> pct(0, 99);
+    std::uniform_int_distribution<int> byteDist(0, 255);
+
+    std::vector<uint8_t> stream;
+    std::deque<TiltSample> intact;
+    uint64_t expectedDropped = 0;
+    bool haveLast = false;
+    uint16_t lastSeq = 0;
+
+    for (int i = 0; i < packets; i++) {
+        TiltSample s;
+        s.seq = static_cast<uint16_t>(i);
+        s.sensorMicros = static_cast<uint32_t>(i) * 5000u;
+        s.angleDeg = std::uniform_real_distribution<float>(0.0f, 360.0f)(rng);
+        s.magnitude = std::uniform_real_distribution<float>(0.0f, 1.0f)(rng);
+        uint8_t pkt[ACCEL_PACKET_SIZE];
+        encodeTiltPacket(s, pkt);
+        if (pct(rng) < 10) {
+            pkt[8 + rng() % 8] = ACCEL_HEADER; // header byte inside payload
+            uint16_t crc = tiltCrc16(&pkt[1], ACCEL_PACKET_SIZE - 3);
+            pkt[16] = crc & 0xFF;
+            pkt[17] = crc >> 8;
+            std::memcpy(&s.angleDeg, &pkt[8], 4);
+            std::memcpy(&s.magnitude, &pkt[12], 4);
+        }
+
+        int roll = pct(rng);
+        if (roll < 5) {
+            continue; // dropped on the wire
+        } else if (roll < 10) {
+            // Single-bit error: always caught by the CRC (or breaks the header)
+            pkt[rng() % ACCEL_PACKET_SIZE] ^= static_cast<uint8_t>(1u << (rng() % 8));
+            stream.insert(stream.end(), pkt, pkt + ACCEL_PACKET_SIZE);
+            continue;
+        } else if (roll < 14) {
+            // Cut somewhere before the CRC (losing only the last CRC byte lets
+            // the next header legitimately complete the packet 1 in 256 times)
+            int keep = 1 + static_cast<int>(rng() % (ACCEL_PACKET_SIZE - 3));
+            stream.insert(stream.end(), pkt, pkt + keep);
+            continue;
+        }
+
+        stream.insert(stream.end(), pkt, pkt + ACCEL_PACKET_SIZE);
+        if (haveLast) {
+            expectedDropped += static_cast<uint16_t>(s.seq - lastSeq) - 1;
+        }
+        haveLast = true;
+        lastSeq = s.seq;
+        intact.push_back(s);
+
+        if (pct(rng) < 8) {
+            int junk = static_cast<int>(rng() % 40);
+            for (int j = 0; j < junk; j++) {
+                stream.push_back(pct(rng) < 20 ? ACCEL_HEADER : static_cast<uint8_t>(byteDist(rng)));
+            }
+        }
+    }
+
+    size_t intactCount = intact.size();
+    uint64_t seedGhosts = 0;
+    TiltParser parser;
+    size_t pos = 0;
+    while (pos < stream.size()) {
+        size_t chunk = 1 + rng() % 200;
+        if (chunk > stream.size() - pos) chunk = stream.size() - pos;
+        parser.feed(&stream[pos], chunk);
+        pos += chunk;
+
+        TiltSample got;
+        if (parser.poll(got)) {
+            std::deque<TiltSample>::iterator it = intact.begin();
+            while (it != intact.end() && !sameSample(*it, got)) ++it;
+            if (it == intact.end()) {
+                seedGhosts++;
+            } else {
+                intact.erase(intact.begin(), it + 1);
+            }
+        }
+    }
+
+    const TiltParserStats& st = parser.stats();
+    ghosts += seedGhosts;
+    corrupt += st.packetsCorrupt;
+    if (seedGhosts > 0) {
+        // A ghost may have swallowed a real packet, so exact counts no longer hold
+        return st.bytesIn == stream.size();
+    }
+    if (st.packetsOk != intactCount) {
+        std::cerr << "seed " << seed << ": packetsOk=" << st.packetsOk << " expected " << intactCount << "\n";
+        return false;
+    }
+    if (st.packetsDropped != expectedDropped) {
+        std::cerr << "seed " << seed << ": packetsDropped=" << st.packetsDropped
+                  << " expected " << expectedDropped << "\n";
+        return false;
+    }
+    if (st.bytesIn != stream.size() || st.bytesOverflowed != 0) {
+        std::cerr << "seed " << seed << ": byte accounting mismatch\n";
+        return false;
+    }
+    return true;
+}
+
+// Clean stream, large reads, to measure raw parse cost.
+static void throughput() {
+    const int packets = 2000000;
+    std::vector<uint8_t> stream(static_cast<size_t>(packets) * ACCEL_PACKET_SIZE);
+    for (int i = 0; i < packets; i++) {
+        TiltSample s = {static_cast<uint16_t>(i), static_cast<uint32_t>(i), i * 0.01f, 0.5f};
+        encodeTiltPacket(s, &stream[static_cast<size_t>(i) * ACCEL_PACKET_SIZE]);
+    }
+
+    TiltParser parser;
+    TiltSample got;
+    auto t0 = std::chrono::steady_clock::now();
+    for (size_t pos = 0; pos < stream.size(); pos += TiltParser::RING_SIZE) {
+        size_t chunk = stream.size() - pos;
+        if (chunk > TiltParser::RING_SIZE) chunk = TiltParser::RING_SIZE;
+        parser.feed(&stream[pos], chunk);
+        parser.poll(got);
+    }
+    double secs = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+
+    std::cout << "Throughput: " << (stream.size() / secs / 1e6) << " MB/s, "
+              << (parser.stats().packetsOk / secs / 1e6) << " Mpkt/s ("
+              << parser.stats().packetsCoalesced << " coalesced)\n";
+}
+
+int main() {
+    int failures = 0;
+    uint64_t ghosts = 0, corrupt = 0;
+    for (unsigned seed = 1; seed <= 200; seed++) {
+        if (!fuzz(seed, 5000, ghosts, corrupt)) failures++;
+    }
+    std::cout << "Fuzz: " << (200 - failures) << "/200 seeds passed, "
+              << corrupt << " corrupt candidates rejected, " << ghosts << " false accepts\n";
+    if (ghosts > corrupt / 65536 * 4 + 4) {
+        std::cerr << "False-accept rate is far above the CRC-16 bound\n";
+        failures++;
+    }
+
+    throughput();
+    return failures == 0 ? 0 : 1;
+}
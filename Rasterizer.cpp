@@ -0,0 +1,126 @@
+#include <vector>
+#include <cmath>
+#include <cstdint>
+#include <algorithm>
+
+// -----------------------------------------------------------------------------
+// Rasterizers: particle positions -> LED brightness for one panel tile.
+// Frames are row-major, tile.rows × tile.cols bytes.
+// -----------------------------------------------------------------------------
+static const int VAR_INTENSITY = 10;
+
+// -----------------------------------------------------------------------------
+// HashGrid for converting SPH positions -> LED brightness. binParticles() bins
+// every particle into the whole wall's LED grid once per frame; hashGrid()
+// then only slices its tile out of those counts. Each particle counts with
+// its mass (merged particles count double), or 1 if 'masses' is empty.
+// -----------------------------------------------------------------------------
+void binParticles(const std::vector<double>& positions,
+                  const std::vector<double>& masses,
+                  const DisplayLayout& layout,
+                  std::vector<double>& ledCounts)
+{
+    ledCounts.assign(static_cast<size_t>(layout.rows) * layout.cols, 0.0);
+
+    const double x0 = layout.xMin();
+    const double y0 = layout.yMin();
+    for (size_t i = 0; i + 1 < positions.size(); i += 2) {
+        double x = positions[i];
+        double y = positions[i+1];
+
+        int x_index = static_cast<int>((x - x0) / layout.cellSize);
+        int y_index = static_cast<int>((y - y0) / layout.cellSize);
+
+        if (x - x0 >= 0.0 && x_index < layout.cols &&
+            y - y0 >= 0.0 && y_index < layout.rows)
+        {
+            ledCounts[y_index * layout.cols + x_index] += masses.empty() ? 1.0 : masses[i / 2];
+        }
+    }
+}
+
+// 'ledCounts' comes from binParticles() over the same layout
+void hashGrid(const std::vector<double>& ledCounts,
+              const DisplayLayout& layout,
+              const PanelTile& tile,
+              unsigned char* ledFrame)
+{
+    for (int r = 0; r < tile.rows; r++) {
+        const double* counts = &ledCounts[(tile.row0 + r) * layout.cols + tile.col0];
+        for (int c = 0; c < tile.cols; c++) {
+            // Convert counts to brightness
+            double countVal = counts[c];
+            if (countVal > VAR_INTENSITY - 1) {
+                countVal = VAR_INTENSITY - 1;
+            }
+            int brightness = static_cast<int>(countVal * (255.0 / (VAR_INTENSITY - 1)));
+            ledFrame[r * tile.cols + c] = static_cast<unsigned char>(brightness);
+        }
+    }
+}
+
+// -----------------------------------------------------------------------------
+// Kernel-density rasterizer: samples the SPH density field at each LED center,
+// sum of mass * W(r) over particles within RADIUS, with the engine's density
+// kernel W = (1 - r/RADIUS)^2. Each particle spreads over the LEDs around it
+// instead of landing in exactly one, so a particle crossing an LED border
+// fades across instead of jumping, and fewer particles light the panel
+// evenly. The kernel comes from a LUT indexed by r^2 (no sqrt) and all
+// accumulation is fixed point.
+//   Full brightness is scaled to match hashGrid on average: the kernel
+// integrates to pi*RADIUS^2/6, so a uniform spread of VAR_INTENSITY - 1
+// particles per LED cell gives the same brightness with either rasterizer.
+// -----------------------------------------------------------------------------
+static const int KERNEL_LUT_SIZE = 256;         // Entries over r^2 in [0, RADIUS^2]
+static const int KERNEL_FRAC_BITS = 12;         // Fixed-point kernel weights (1.0 = 4096)
+static const int MASS_FRAC_BITS = 8;            // Fixed-point particle mass (1.0 = 256)
+
+struct KernelLUT {
+    uint16_t weight[KERNEL_LUT_SIZE + 1];
+
+    KernelLUT() {
+        for (int k = 0; k <= KERNEL_LUT_SIZE; k++) {
+            double q = 1.0 - std::sqrt(static_cast<double>(k) / KERNEL_LUT_SIZE);
+            weight[k] = static_cast<uint16_t>(std::lround(q * q * (1 << KERNEL_FRAC_BITS)));
+        }
+    }
+};
+
+// 'grid' must have been built over the same 'positions' (see NeighborGrid),
+// once per frame before the tiles are rasterized.
+void kernelDensity(const std::vector<double>& positions,
+                   const std::vector<double>& masses,
+                   const NeighborGrid& grid,
+                   const DisplayLayout& layout,
+                   const PanelTile& tile,
+                   unsigned char* ledFrame)
+{
+    static const KernelLUT lut;
+    const double lutScale = KERNEL_LUT_SIZE / (RADIUS * RADIUS);
+    const uint32_t unitMass = 1u << MASS_FRAC_BITS;
+    // density (KERNEL_FRAC_BITS) -> 0..255, in 16.16
+    const double fullDensity = (VAR_INTENSITY - 1) * (M_PI * RADIUS * RADIUS / 6.0)
+                             / (layout.cellSize * layout.cellSize);
+    const uint64_t brightnessScale = static_cast<uint64_t>(
+        std::lround(255.0 * 65536.0 / (fullDensity * (1 << KERNEL_FRAC_BITS))));
+
+    for (int r = 0; r < tile.rows; r++) {
+        const double y = layout.yMin() + (tile.row0 + r + 0.5) * layout.cellSize;
+        for (int c = 0; c < tile.cols; c++) {
+            const double x = layout.xMin() + (tile.col0 + c + 0.5) * layout.cellSize;
+            uint32_t density = 0;
+            grid.for_each_near(x, y, [&](int j) {
+                double dx = positions[2*j] - x;
+                double dy = positions[2*j + 1] - y;
+                double k = (dx*dx + dy*dy) * lutScale;
+                if (k < KERNEL_LUT_SIZE) {
+                    uint32_t m = masses.empty() ? unitMass
+                        : static_cast<uint32_t>(masses[j] * unitMass + 0.5);
+                    density += (lut.weight[static_cast<int>(k)] * m) >> MASS_FRAC_BITS;
+                }
+            });
+            uint32_t brightness = static_cast<uint32_t>((density * brightnessScale) >> 16);
+            ledFrame[r * tile.cols + c] = static_cast<unsigned char>(std::min<uint32_t>(brightness, 255));
+        }
+    }
+}
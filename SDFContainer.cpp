@@ -0,0 +1,214 @@
+#include <cmath>
+#include <vector>
+#include <limits>
+#include <algorithm>
+#include <cstdint>
+
+// -----------------------------------------------------------------------------
+// Signed-distance-field container
+//   A precomputed grid of signed distances to the fluid boundary: positive
+//   inside the fluid region, negative inside walls and obstacles. Particles
+//   only ever do one bilinear lookup (value + gradient), so the boundary costs
+//   the same no matter how many shapes went into building it.
+//
+//   Building: start from a container shape, then carve out obstacles. Shapes
+//   are combined as fluid = container AND NOT obstacle, i.e. phi = min(...).
+// -----------------------------------------------------------------------------
+class SDFGrid {
+public:
+    SDFGrid() : nx(0), ny(0), x0(0.0), y0(0.0), h(1.0) {}
+
+    // Grid covering [xmin, xmax] x [ymin, ymax] plus at least 'pad' on every
+    // side, with nodes every 'spacing'. Starts as an unbounded fluid region.
+    SDFGrid(double xmin, double xmax, double ymin, double ymax, double spacing, double pad)
+      : h(spacing)
+    {
+        // Nodes sit half a spacing off the bounds, so edges that are a whole
+        // number of spacings from xmin/ymin (LED cells) fall between nodes
+        double margin = (std::ceil(pad / h) + 0.5) * h;
+        x0 = xmin - margin;
+        y0 = ymin - margin;
+        nx = static_cast<int>(std::ceil((xmax + margin - x0) / h)) + 1;
+        ny = static_cast<int>(std::ceil((ymax + margin - y0) / h)) + 1;
+        phi.assign(static_cast<size_t>(nx) * ny, std::numeric_limits<double>::max());
+    }
+
+    // --- Containers (fluid inside) ---
+
+    void intersectBox(double xmin, double xmax, double ymin, double ymax) {
+        double cx = 0.5 * (xmin + xmax), cy = 0.5 * (ymin + ymax);
+        double hx = 0.5 * (xmax - xmin), hy = 0.5 * (ymax - ymin);
+        combine([=](double x, double y) { return -boxDistance(x - cx, y - cy, hx, hy, 0.0); });
+    }
+
+    void intersectRoundedBox(double xmin, double xmax, double ymin, double ymax, double radius) {
+        double cx = 0.5 * (xmin + xmax), cy = 0.5 * (ymin + ymax);
+        double hx = 0.5 * (xmax - xmin), hy = 0.5 * (ymax - ymin);
+        radius = std::min(radius, std::min(hx, hy));
+        combine([=](double x, double y) { return -boxDistance(x - cx, y - cy, hx, hy, radius); });
+    }
+
+    void intersectEllipse(double cx, double cy, double rx, double ry) {
+        combine([=](double x, double y) { return -ellipseDistance(x - cx, y - cy, rx, ry); });
+    }
+
+    // --- Obstacles (solid inside) ---
+
+    void subtractBox(double xmin, double xmax, double ymin, double ymax) {
+        double cx = 0.5 * (xmin + xmax), cy = 0.5 * (ymin + ymax);
+        double hx = 0.5 * (xmax - xmin), hy = 0.5 * (ymax - ymin);
+        combine([=](double x, double y) { return boxDistance(x - cx, y - cy, hx, hy, 0.0); });
+    }
+
+    void subtractCircle(double cx, double cy, double r) {
+        combine([=](double x, double y) { return std::hypot(x - cx, y - cy) - r; });
+    }
+
+    // Carve out a bitmap of solid cells. solid[r * cols + c] != 0 marks the
+    // cell [mx0 + c*cell, mx0 + (c+1)*cell] x [my0 + r*cell, my0 + (r+1)*cell]
+    // (row 0 at the bottom). Distances come from an exact Euclidean distance
+    // transform over the grid nodes, so building is linear in the node count.
+    void subtractMask(const std::vector<uint8_t>& solid, int rows, int cols,
+                      double mx0, double my0, double cell) {
+        const size_t nodes = phi.size();
+        std::vector<uint8_t> nodeSolid(nodes, 0);
+        bool any = false;
+        for (int j = 0; j < ny; j++) {
+            for (int i = 0; i < nx; i++) {
+                int c = static_cast<int>(std::floor((x0 + i * h - mx0) / cell));
+                int r = static_cast<int>(std::floor((y0 + j * h - my0) / cell));
+                if (r >= 0 && r < rows && c >= 0 && c < cols && solid[r * cols + c]) {
+                    nodeSolid[index(i, j)] = 1;
+                    any = true;
+                }
+            }
+        }
+        if (!any) return;
+
+        std::vector<double> toSolid(nodes), toFluid(nodes);
+        distanceTransform(nodeSolid, 1, toSolid);
+        distanceTransform(nodeSolid, 0, toFluid);
+        for (size_t k = 0; k < nodes; k++) {
+            // The true boundary lies about half a node between the two sets
+            double d = nodeSolid[k] ? -(std::sqrt(toFluid[k]) - 0.5) * h
+                                    : (std::sqrt(toSolid[k]) - 0.5) * h;
+            phi[k] = std::min(phi[k], d);
+        }
+    }
+
+    // --- Lookup ---
+
+    // Signed distance at (x, y) and its unit gradient (pointing into the
+    // fluid). Outside the grid the nearest edge value is extended linearly.
+    inline double sample(double x, double y, double& gx, double& gy) const {
+        double fx = (x - x0) / h;
+        double fy = (y - y0) / h;
+        // Written so that NaN (a blown-up particle) clamps to a node too
+        double cfx = (fx > 0.0) ? std::min(fx, nx - 1.000001) : 0.0;
+        double cfy = (fy > 0.0) ? std::min(fy, ny - 1.000001) : 0.0;
+        int i = static_cast<int>(cfx);
+        int j = static_cast<int>(cfy);
+        double tx = cfx - i, ty = cfy - j;
+
+        double p00 = phi[index(i, j)],     p10 = phi[index(i + 1, j)];
+        double p01 = phi[index(i, j + 1)], p11 = phi[index(i + 1, j + 1)];
+        double value = (1 - ty) * ((1 - tx) * p00 + tx * p10) + ty * ((1 - tx) * p01 + tx * p11);
+        gx = (1 - ty) * (p10 - p00) + ty * (p11 - p01);
+        gy = (1 - tx) * (p01 - p00) + tx * (p11 - p10);
+        double len = std::sqrt(gx * gx + gy * gy);
+        if (len > 0.0) {
+            gx /= len;
+            gy /= len;
+        }
+
+        double ox = (fx - cfx) * h, oy = (fy - cfy) * h;
+        if (ox != 0.0 || oy != 0.0) {
+            value -= std::sqrt(ox * ox + oy * oy);
+        }
+        return value;
+    }
+
+    bool empty() const { return phi.empty(); }
+
+private:
+    size_t index(int i, int j) const { return static_cast<size_t>(j) * nx + i; }
+
+    template <typename F>
+    void combine(F shapeDistance) {
+        for (int j = 0; j < ny; j++) {
+            for (int i = 0; i < nx; i++) {
+                double d = shapeDistance(x0 + i * h, y0 + j * h);
+                double& p = phi[index(i, j)];
+                if (d < p) p = d;
+            }
+        }
+    }
+
+    // Signed distance to a (rounded) box centered at the origin, positive outside
+    static double boxDistance(double px, double py, double hx, double hy, double r) {
+        double qx = std::fabs(px) - (hx - r);
+        double qy = std::fabs(py) - (hy - r);
+        double ox = std::max(qx, 0.0), oy = std::max(qy, 0.0);
+        return std::sqrt(ox * ox + oy * oy) + std::min(std::max(qx, qy), 0.0) - r;
+    }
+
+    // Approximate signed distance to an axis-aligned ellipse, positive outside
+    static double ellipseDistance(double px, double py, double rx, double ry) {
+        double k0 = std::hypot(px / rx, py / ry);
+        double k1 = std::hypot(px / (rx * rx), py / (ry * ry));
+        if (k1 == 0.0) return -std::min(rx, ry);
+        return k0 * (k0 - 1.0) / k1;
+    }
+
+    // Squared distance (in nodes) from every node to the nearest node whose
+    // nodeSolid equals 'target' (Felzenszwalb & Huttenlocher, separable).
+    void distanceTransform(const std::vector<uint8_t>& nodeSolid, uint8_t target,
+                           std::vector<double>& out) const {
+        const double INF = 1e20;
+        for (size_t k = 0; k < out.size(); k++) {
+            out[k] = (nodeSolid[k] == target) ? 0.0 : INF;
+        }
+        std::vector<double> f(std::max(nx, ny)), d(std::max(nx, ny));
+        std::vector<double> z(std::max(nx, ny) + 1);
+        std::vector<int> v(std::max(nx, ny));
+        for (int j = 0; j < ny; j++) {
+            for (int i = 0; i < nx; i++) f[i] = out[index(i, j)];
+            transform1D(f, nx, d, v, z);
+            for (int i = 0; i < nx; i++) out[index(i, j)] = d[i];
+        }
+        for (int i = 0; i < nx; i++) {
+            for (int j = 0; j < ny; j++) f[j] = out[index(i, j)];
+            transform1D(f, ny, d, v, z);
+            for (int j = 0; j < ny; j++) out[index(i, j)] = d[j];
+        }
+    }
+
+    static void transform1D(const std::vector<double>& f, int n, std::vector<double>& d,
+                            std::vector<int>& v, std::vector<double>& z) {
+        int k = 0;
+        v[0] = 0;
+        z[0] = -std::numeric_limits<double>::infinity();
+        z[1] = std::numeric_limits<double>::infinity();
+        for (int q = 1; q < n; q++) {
+            double s = ((f[q] + q * q) - (f[v[k]] + v[k] * v[k])) / (2.0 * q - 2.0 * v[k]);
+            while (s <= z[k]) {
+                k--;
+                s = ((f[q] + q * q) - (f[v[k]] + v[k] * v[k])) / (2.0 * q - 2.0 * v[k]);
+            }
+            k++;
+            v[k] = q;
+            z[k] = s;
+            z[k + 1] = std::numeric_limits<double>::infinity();
+        }
+        k = 0;
+        for (int q = 0; q < n; q++) {
+            while (z[k + 1] < q) k++;
+            double dq = q - v[k];
+            d[q] = dq * dq + f[v[k]];
+        }
+    }
+
+    int nx, ny;
+    double x0, y0, h;
+    std::vector<double> phi;
+};
@@ -3,6 +3,9 @@
 #include <cmath>
 #include <vector>
 #include <random>
+#include <algorithm>
+
+#include "SDFContainer.cpp"
 
 // namespace py = pybind11;
 
@@ -26,6 +29,23 @@ const double SIGMA = 0.2;
 const double MAX_VEL = 2.0;
 const double WALL_DAMP = 1.0;
 const double VEL_DAMP = 0.5;
+const double SDF_SPACING = 0.025;  // Container SDF node spacing (quarter of an LED)
+const double SDF_PAD = RADIUS;     // SDF margin around the container bounds
+const double SOLID_PUSH_MARGIN = 0.1 * RADIUS;  // Clearance when moving particles out of solids
+
+// Position-based fluids (Macklin & Müller 2013), same kernel as the density pass
+const double PBF_REST_DENSITY = 7.5;    // Target density, self included (settles as
+                                        // deep as the double-density solver)
+const double PBF_RELAXATION = 180.0;    // Regularizes lambda (constraint force mixing); the
+                                        // Jacobi rounds overshoot and never settle at dt > 2
+                                        // when this is much smaller
+const double PBF_XSPH = 0.3;            // XSPH velocity smoothing per unit of time
+const int PBF_ITERATIONS = 8;
+
+enum class Solver {
+    DoubleDensity,   // Double-density relaxation (Clavet et al. 2005), the default
+    PositionBased    // Iterative density constraints; stable at larger dt
+};
 
 // --- Particle class ---
 struct Particle {
@@ -36,6 +56,7 @@ struct Particle {
     double press, press_near;
     double x_vel, y_vel;
     double x_force, y_force;
+    double mass;                 // 1 per original particle; >1 after merging
     std::vector<int> neighbors;  // store indices of neighbors
 
     Particle(double x, double y)
@@ -45,18 +66,21 @@ struct Particle {
         rho(0.0), rho_near(0.0),
         press(0.0), press_near(0.0),
         x_vel(0.0), y_vel(0.0),
-        x_force(G_X), y_force(G_Y)
+        x_force(G_X), y_force(G_Y),
+        mass(1.0)
     {}
 
-    void update_state(double g_mag, double g_ang) {
+    // Integrate one step of length dt and push the particle back into the
+    // container. Time is measured in original steps, so dt = 1 is one step.
+    void update_state(double g_mag, double g_ang, const SDFGrid& container, double dt = 1.0) {
         previous_x_pos = x_pos;
         previous_y_pos = y_pos;
         // Euler integration: update velocity from force
-        x_vel += x_force;
-        y_vel += y_force;
+        x_vel += x_force * dt;
+        y_vel += y_force * dt;
         // Update position
-        x_pos += x_vel;
-        y_pos += y_vel;
+        x_pos += x_vel * dt;
+        y_pos += y_vel * dt;
         // Set visual positions
         visual_x_pos = x_pos;
         visual_y_pos = y_pos;
@@ -64,29 +88,22 @@ struct Particle {
         x_force = std::cos(g_ang) * g_mag;
         y_force = std::sin(g_ang) * g_mag;
         // Recompute velocity from position difference
-        x_vel = x_pos - previous_x_pos;
-        y_vel = y_pos - previous_y_pos;
+        x_vel = (x_pos - previous_x_pos) / dt;
+        y_vel = (y_pos - previous_y_pos) / dt;
         double velocity = std::sqrt(x_vel*x_vel + y_vel*y_vel);
         if (velocity > MAX_VEL) {
             x_vel *= VEL_DAMP;
             y_vel *= VEL_DAMP;
         }
-        // Wall constraints
-        if (x_pos < -SIM_W) {
-            x_force -= (x_pos - (-SIM_W)) * WALL_DAMP;
-            visual_x_pos = -SIM_W;
-        }
-        if (x_pos > SIM_W) {
-            x_force -= (x_pos - SIM_W) * WALL_DAMP;
-            visual_x_pos = SIM_W;
-        }
-        if (y_pos < BOTTOM) {
-            y_force -= (y_pos - BOTTOM) * WALL_DAMP;
-            visual_y_pos = BOTTOM;
-        }
-        if (y_pos > TOP) {
-            y_force -= (y_pos - TOP) * WALL_DAMP;
-            visual_y_pos = TOP;
+        // Wall constraints: a negative distance means we are inside a wall or
+        // obstacle; spring back along the gradient and draw on the surface
+        double nx, ny;
+        double dist = container.sample(x_pos, y_pos, nx, ny);
+        if (dist < 0.0) {
+            x_force -= dist * nx * WALL_DAMP;
+            y_force -= dist * ny * WALL_DAMP;
+            visual_x_pos = x_pos - dist * nx;
+            visual_y_pos = y_pos - dist * ny;
         }
         // Reset densities and neighbor list
         rho = 0.0;
@@ -100,13 +117,141 @@ struct Particle {
     }
 };
 
+// --- Wall term for position-based fluids ---
+// Fraction of the density kernel's mass that lies beyond a straight wall at
+// distance s * RADIUS from a particle (s in [-1, 1], negative inside the
+// wall). Walls count toward PBF density as if filled with fluid at rest, so
+// particles settle a little off the wall instead of collapsing onto it.
+struct WallKernel {
+    static const int SIZE = 64;
+    double fraction[SIZE + 1];  // For s = 0 .. 1
+
+    WallKernel() {
+        // Ring of radius r beyond the wall spans an angle of 2 acos(s / r)
+        const int STEPS = 512;
+        const double total = M_PI / 6.0;  // Integral of (1 - r)^2 over the unit disk
+        for (int k = 0; k <= SIZE; k++) {
+            double s = static_cast<double>(k) / SIZE;
+            double sum = 0.0;
+            for (int m = 0; m < STEPS; m++) {
+                double r = s + (1.0 - s) * (m + 0.5) / STEPS;
+                sum += (1.0 - r) * (1.0 - r) * 2.0 * r * std::acos(std::min(s / r, 1.0));
+            }
+            fraction[k] = sum * (1.0 - s) / STEPS / total;
+        }
+    }
+
+    // Fraction at s, and its derivative d/ds
+    double sample(double s, double &slope) const {
+        bool inside = s < 0.0;
+        double a = std::min(std::fabs(s), 1.0) * SIZE;
+        int k = std::min(static_cast<int>(a), SIZE - 1);
+        double t = a - k;
+        double f = fraction[k] + t * (fraction[k + 1] - fraction[k]);
+        slope = (fraction[k + 1] - fraction[k]) * SIZE;
+        // Mirror for s < 0: F(-s) = 1 - F(s), same slope
+        return inside ? 1.0 - f : f;
+    }
+};
+
+// --- Uniform neighbor grid ---
+// Cell-linked list over [xmin, xmax] x [ymin, ymax] with cells of at least
+// the interaction radius, so every point within RADIUS of (x, y) lies in the
+// 3×3 cells around it. Points outside the bounds are clamped into the edge
+// cells, which keeps that property.
+class NeighborGrid {
+public:
+    NeighborGrid() : x0(0.0), y0(0.0), cell(1.0), nx(1), ny(1), head(1, -1) {}
+
+    NeighborGrid(double xmin, double xmax, double ymin, double ymax, double cell_size)
+      : x0(xmin), y0(ymin), cell(cell_size) {
+        nx = std::max(1, static_cast<int>(std::ceil((xmax - xmin) / cell)));
+        ny = std::max(1, static_cast<int>(std::ceil((ymax - ymin) / cell)));
+        head.assign(static_cast<size_t>(nx) * ny, -1);
+    }
+
+    void build(const std::vector<Particle>& particles) {
+        reset(particles.size());
+        for (size_t i = 0; i < particles.size(); i++) {
+            insert(i, particles[i].x_pos, particles[i].y_pos);
+        }
+    }
+
+    // Flattened (x0, y0, x1, y1, ...) positions
+    void build(const std::vector<double>& positions) {
+        reset(positions.size() / 2);
+        for (size_t i = 0; i + 1 < positions.size(); i += 2) {
+            insert(i / 2, positions[i], positions[i+1]);
+        }
+    }
+
+    // Call f(j) for every point in the 3×3 cells around (x, y), in no
+    // particular order
+    template <typename F>
+    void for_each_near(double x, double y, F f) const {
+        int cx, cy;
+        cell_of(x, y, cx, cy);
+        for (int gy = std::max(cy - 1, 0); gy <= std::min(cy + 1, ny - 1); gy++) {
+            for (int gx = std::max(cx - 1, 0); gx <= std::min(cx + 1, nx - 1); gx++) {
+                for (int j = head[gy * nx + gx]; j >= 0; j = next[j]) {
+                    f(j);
+                }
+            }
+        }
+    }
+
+private:
+    void reset(size_t count) {
+        std::fill(head.begin(), head.end(), -1);
+        next.resize(count);
+    }
+
+    void insert(size_t i, double x, double y) {
+        int cx, cy;
+        cell_of(x, y, cx, cy);
+        int& first = head[cy * nx + cx];
+        next[i] = first;
+        first = static_cast<int>(i);
+    }
+
+    void cell_of(double x, double y, int& cx, int& cy) const {
+        double fx = std::floor((x - x0) / cell);
+        double fy = std::floor((y - y0) / cell);
+        cx = (fx > 0.0) ? static_cast<int>(std::min(fx, nx - 1.0)) : 0;
+        cy = (fy > 0.0) ? static_cast<int>(std::min(fy, ny - 1.0)) : 0;
+    }
+
+    double x0, y0, cell;
+    int nx, ny;
+    std::vector<int> head;  // First point in each cell, -1 if empty
+    std::vector<int> next;  // Next point in the same cell, -1 at the end
+};
+
 // --- Simulation class ---
 class Simulation {
 public:
     std::vector<Particle> particles;
+    double x_min, x_max, y_min, y_max;  // Container bounds
+    SDFGrid container;                  // Walls and obstacles within the bounds
+    NeighborGrid grid;                  // Rebuilt every step for the density pass
+
+    // Level-of-detail knobs (see FrameGovernor.cpp); defaults are full quality
+    int viscosity_interval = 1;         // Apply viscosity every Nth step
+    int max_neighbors = 0;              // Cap on pairs per neighbor list, nearest kept (0 = none)
+    long step_count = 0;
 
-    // Constructor: create "count" particles randomly in [xmin, xmax] x [ymin, ymax]
-    Simulation(int count, double xmin, double xmax, double ymin, double ymax) {
+    // Solver backend and step length (in original steps; see update_state)
+    Solver solver = Solver::DoubleDensity;
+    int solver_iterations = PBF_ITERATIONS;  // Constraint iterations per step (PBF)
+    double dt = 1.0;
+
+    // Constructor: create "count" particles randomly in [xmin, xmax] x [ymin, ymax],
+    // which is also the (box) container the particles are kept in
+    Simulation(int count, double xmin, double xmax, double ymin, double ymax)
+      : x_min(xmin), x_max(xmax), y_min(ymin), y_max(ymax),
+        container(xmin, xmax, ymin, ymax, SDF_SPACING, SDF_PAD),
+        grid(xmin, xmax, ymin, ymax, RADIUS) {
+        container.intersectBox(xmin, xmax, ymin, ymax);
         particles.reserve(count);
         std::random_device rd;
         std::mt19937 gen(rd());
@@ -119,24 +264,57 @@ public:
         }
     }
 
-    // Calculate density and near density by looping over particle pairs.
+    // Replace the container (built over the same bounds). Particles that end up
+    // inside a wall or obstacle are moved back into the fluid region, keeping
+    // their mass (see move_out_of_solids).
+    void set_container(const SDFGrid& sdf) {
+        container = sdf;
+        std::random_device rd;
+        std::mt19937 gen(rd());
+        for (auto &p : particles) {
+            move_out_of_solids(p, gen);
+        }
+    }
+
+    // Calculate density and near density over particle pairs found through
+    // the neighbor grid. Each pair is visited once (j > i) and in increasing j,
+    // so the neighbor lists come out in the same order as a full pair loop.
     void calculate_density() {
         int n = particles.size();
+        grid.build(particles);
         for (int i = 0; i < n; i++) {
             double density = 0.0;
             double density_near = 0.0;
-            for (int j = i+1; j < n; j++) {
+            candidates.clear();
+            grid.for_each_near(particles[i].x_pos, particles[i].y_pos, [&](int j) {
+                if (j > i) candidates.push_back(j);
+            });
+            std::sort(candidates.begin(), candidates.end());
+            near_pairs.clear();
+            for (int j : candidates) {
                 double dx = particles[i].x_pos - particles[j].x_pos;
                 double dy = particles[i].y_pos - particles[j].y_pos;
                 double dist = std::sqrt(dx*dx + dy*dy);
-                if (dist < RADIUS) {
-                    double q = 1.0 - dist / RADIUS;
-                    density += q*q;
-                    density_near += q*q*q;
-                    particles[j].rho += q*q;
-                    particles[j].rho_near += q*q*q;
-                    particles[i].neighbors.push_back(j);
-                }
+                if (dist < RADIUS) near_pairs.push_back({dist, j});
+            }
+            // Under a cap, keep the nearest pairs (back in j order); dropped
+            // pairs count toward neither density nor forces
+            if (max_neighbors > 0 && (int)near_pairs.size() > max_neighbors) {
+                std::nth_element(near_pairs.begin(), near_pairs.begin() + max_neighbors, near_pairs.end());
+                near_pairs.resize(max_neighbors);
+                std::sort(near_pairs.begin(), near_pairs.end(),
+                          [](const std::pair<double, int>& a, const std::pair<double, int>& b) {
+                              return a.second < b.second;
+                          });
+            }
+            for (const auto& pair : near_pairs) {
+                int j = pair.second;
+                double q = 1.0 - pair.first / RADIUS;
+                density += particles[j].mass * q*q;
+                density_near += particles[j].mass * q*q*q;
+                particles[j].rho += particles[i].mass * q*q;
+                particles[j].rho_near += particles[i].mass * q*q*q;
+                particles[i].neighbors.push_back(j);
             }
             particles[i].rho += density;
             particles[i].rho_near += density_near;
@@ -159,13 +337,13 @@ public:
                     + (particles[i].press_near + particles[j].press_near) * (q*q*q);
                 double px = dx * total_pressure / dist;
                 double py = dy * total_pressure / dist;
-                particles[j].x_force += px;
-                particles[j].y_force += py;
+                particles[j].x_force += px / particles[j].mass;
+                particles[j].y_force += py / particles[j].mass;
                 press_x += px;
                 press_y += py;
             }
-            particles[i].x_force -= press_x;
-            particles[i].y_force -= press_y;
+            particles[i].x_force -= press_x / particles[i].mass;
+            particles[i].y_force -= press_y / particles[i].mass;
         }
     }
 
@@ -184,13 +362,16 @@ public:
                 double velocity_diff = (particles[i].x_vel - particles[j].x_vel)*nx +
                                          (particles[i].y_vel - particles[j].y_vel)*ny;
                 if (velocity_diff > 0) {
-                    double factor = (1.0 - relative_distance) * SIGMA * velocity_diff;
+                    double factor = (1.0 - relative_distance) * SIGMA * velocity_diff * dt;
                     double viscosity_x = factor * nx;
                     double viscosity_y = factor * ny;
-                    particles[i].x_vel -= viscosity_x * 0.5;
-                    particles[i].y_vel -= viscosity_y * 0.5;
-                    particles[j].x_vel += viscosity_x * 0.5;
-                    particles[j].y_vel += viscosity_y * 0.5;
+                    // Split the impulse by mass (0.5 each for equal masses)
+                    double share_i = particles[j].mass / (particles[i].mass + particles[j].mass);
+                    double share_j = 1.0 - share_i;
+                    particles[i].x_vel -= viscosity_x * share_i;
+                    particles[i].y_vel -= viscosity_y * share_i;
+                    particles[j].x_vel += viscosity_x * share_j;
+                    particles[j].y_vel += viscosity_y * share_j;
                 }
             }
         }
@@ -198,17 +379,312 @@ public:
 
     // Update one simulation step.
     void update(double g_mag = G_MAG, double g_ang = G_ANG) {
+        if (solver == Solver::PositionBased) {
+            update_position_based(g_mag, g_ang);
+            step_count++;
+            return;
+        }
+        integrate(g_mag, g_ang);
+        calculate_density();
+        calculate_pressures();
+        create_pressure();
+        if (step_count % viscosity_interval == 0) {
+            calculate_viscosity();
+        }
+        step_count++;
+    }
+
+    // Update state of each particle.
+    void integrate(double g_mag = G_MAG, double g_ang = G_ANG) {
         int n = particles.size();
-        // Update state of each particle.
         for (int i = 0; i < n; i++) {
-            particles[i].update_state(g_mag, g_ang);
+            particles[i].update_state(g_mag, g_ang, container, dt);
         }
-        calculate_density();
+    }
+
+    // Pressure of each particle from its density.
+    void calculate_pressures() {
+        int n = particles.size();
         for (int i = 0; i < n; i++) {
             particles[i].calculate_pressure();
         }
-        create_pressure();
-        calculate_viscosity();
+    }
+
+    // One position-based-fluids step: predict positions under gravity, then
+    // 'solver_iterations' rounds of moving particles so that no density is
+    // above PBF_REST_DENSITY, pushing them out of walls after every round.
+    // Velocities come from the corrected positions, so the step stays stable
+    // at larger dt than the double-density solver's, which diverges above 1.
+    void update_position_based(double g_mag, double g_ang) {
+        int n = particles.size();
+        double gx = std::cos(g_ang) * g_mag;
+        double gy = std::sin(g_ang) * g_mag;
+
+        // Predict
+        for (auto &p : particles) {
+            p.previous_x_pos = p.x_pos;
+            p.previous_y_pos = p.y_pos;
+            p.x_vel += gx * dt;
+            p.y_vel += gy * dt;
+            p.x_pos += p.x_vel * dt;
+            p.y_pos += p.y_vel * dt;
+            p.x_force = gx;
+            p.y_force = gy;
+        }
+        project_out_of_walls();
+
+        // Neighbor lists at the predicted positions, kept for the whole step.
+        // Kernel gradients per pair are cached in neighbor-list order.
+        for (auto &p : particles) {
+            p.rho = 0.0;
+            p.rho_near = 0.0;
+            p.neighbors.clear();
+        }
+        calculate_density();
+        pair_start.resize(n + 1);
+        size_t pairs = 0;
+        for (int i = 0; i < n; i++) {
+            pair_start[i] = pairs;
+            pairs += particles[i].neighbors.size();
+        }
+        pair_start[n] = pairs;
+        pair_wx.resize(pairs);
+        pair_wy.resize(pairs);
+
+        lambda.resize(n);
+        grad_x.resize(n);
+        grad_y.resize(n);
+        grad_sq.resize(n);
+        delta_x.resize(n);
+        delta_y.resize(n);
+        wall_gx.resize(n);
+        wall_gy.resize(n);
+        static const WallKernel wall_kernel;
+        for (int it = 0; it < solver_iterations; it++) {
+            // Wall density and its gradient (d/dx of rho_wall / rest)
+            for (int i = 0; i < n; i++) {
+                Particle &p = particles[i];
+                double nx, ny, slope;
+                double dist = container.sample(p.x_pos, p.y_pos, nx, ny);
+                p.rho = 0.0;
+                wall_gx[i] = 0.0;
+                wall_gy[i] = 0.0;
+                if (dist < RADIUS) {
+                    p.rho = PBF_REST_DENSITY * wall_kernel.sample(dist / RADIUS, slope);
+                    wall_gx[i] = slope / RADIUS * nx;
+                    wall_gy[i] = slope / RADIUS * ny;
+                }
+                grad_x[i] = wall_gx[i];
+                grad_y[i] = wall_gy[i];
+                grad_sq[i] = 0.0;
+            }
+
+            // Densities and constraint gradients, C_i = rho_i / rest - 1,
+            // with the self and wall terms included
+            for (int i = 0; i < n; i++) {
+                Particle &a = particles[i];
+                double mi = a.mass / PBF_REST_DENSITY;
+                for (size_t k = pair_start[i]; k < pair_start[i + 1]; k++) {
+                    int j = a.neighbors[k - pair_start[i]];
+                    Particle &b = particles[j];
+                    double dx = a.x_pos - b.x_pos;
+                    double dy = a.y_pos - b.y_pos;
+                    double dist = std::sqrt(dx*dx + dy*dy);
+                    pair_wx[k] = pair_wy[k] = 0.0;
+                    if (dist >= RADIUS) continue;
+                    double q = 1.0 - dist / RADIUS;
+                    a.rho += b.mass * q*q;
+                    b.rho += a.mass * q*q;
+                    if (dist == 0.0) continue;
+                    double dw = -2.0 * q / RADIUS;
+                    double wx = dw * dx / dist, wy = dw * dy / dist;
+                    pair_wx[k] = wx;
+                    pair_wy[k] = wy;
+                    double mj = b.mass / PBF_REST_DENSITY;
+                    grad_x[i] += mj * wx;
+                    grad_y[i] += mj * wy;
+                    grad_sq[i] += mj * mj * (wx*wx + wy*wy);
+                    grad_x[j] -= mi * wx;
+                    grad_y[j] -= mi * wy;
+                    grad_sq[j] += mi * mi * (wx*wx + wy*wy);
+                }
+            }
+            for (int i = 0; i < n; i++) {
+                // Only compression is corrected, so a free surface does not clump
+                double c = (particles[i].mass + particles[i].rho) / PBF_REST_DENSITY - 1.0;
+                double denom = grad_x[i]*grad_x[i] + grad_y[i]*grad_y[i] + grad_sq[i] + PBF_RELAXATION;
+                lambda[i] = -std::max(c, 0.0) / denom;
+            }
+
+            // Position corrections, applied symmetrically per pair (the wall
+            // only moves the particle). There is no artificial pressure term:
+            // applied every round it acts as a repulsion that grows with the
+            // rounds per unit of time, so the depth would depend on dt and
+            // 'solver_iterations'.
+            for (int i = 0; i < n; i++) {
+                delta_x[i] = lambda[i] * wall_gx[i];
+                delta_y[i] = lambda[i] * wall_gy[i];
+            }
+            for (int i = 0; i < n; i++) {
+                const Particle &a = particles[i];
+                for (size_t k = pair_start[i]; k < pair_start[i + 1]; k++) {
+                    if (pair_wx[k] == 0.0 && pair_wy[k] == 0.0) continue;
+                    int j = a.neighbors[k - pair_start[i]];
+                    double scale = (lambda[i] + lambda[j]) / PBF_REST_DENSITY;
+                    delta_x[i] += particles[j].mass * scale * pair_wx[k];
+                    delta_y[i] += particles[j].mass * scale * pair_wy[k];
+                    delta_x[j] -= a.mass * scale * pair_wx[k];
+                    delta_y[j] -= a.mass * scale * pair_wy[k];
+                }
+            }
+            for (int i = 0; i < n; i++) {
+                particles[i].x_pos += delta_x[i];
+                particles[i].y_pos += delta_y[i];
+            }
+            project_out_of_walls();
+        }
+
+        // Velocities from the corrected positions
+        for (auto &p : particles) {
+            p.x_vel = (p.x_pos - p.previous_x_pos) / dt;
+            p.y_vel = (p.y_pos - p.previous_y_pos) / dt;
+            p.visual_x_pos = p.x_pos;
+            p.visual_y_pos = p.y_pos;
+        }
+
+        // XSPH viscosity: blend each velocity toward its neighbors'
+        if (step_count % viscosity_interval == 0) {
+            // Same smoothing per unit of time whatever the step length
+            const double xsph = 1.0 - std::pow(1.0 - PBF_XSPH, dt);
+            for (int i = 0; i < n; i++) {
+                for (int j : particles[i].neighbors) {
+                    double dx = particles[i].x_pos - particles[j].x_pos;
+                    double dy = particles[i].y_pos - particles[j].y_pos;
+                    double dist = std::sqrt(dx*dx + dy*dy);
+                    if (dist >= RADIUS) continue;
+                    double q = 1.0 - dist / RADIUS;
+                    double share_i = particles[j].mass / (particles[i].mass + particles[j].mass);
+                    double share_j = 1.0 - share_i;
+                    double vx = (particles[j].x_vel - particles[i].x_vel) * xsph * q*q;
+                    double vy = (particles[j].y_vel - particles[i].y_vel) * xsph * q*q;
+                    particles[i].x_vel += vx * share_i;
+                    particles[i].y_vel += vy * share_i;
+                    particles[j].x_vel -= vx * share_j;
+                    particles[j].y_vel -= vy * share_j;
+                }
+            }
+        }
+    }
+
+    // Merge up to 'max_merges' pairs of neighboring particles into one particle
+    // of their combined mass (at their center of mass), never exceeding
+    // 'max_mass'. Uses the neighbor lists of the last step. Returns the number
+    // of merges; total mass is unchanged.
+    int merge_particles(int max_merges, double max_mass) {
+        int n = particles.size();
+        std::vector<char> gone(n, 0);
+        int merges = 0;
+        for (int i = 0; i < n && merges < max_merges; i++) {
+            if (gone[i]) continue;
+            Particle &a = particles[i];
+            int best = -1;
+            double best_dist = RADIUS * RADIUS;
+            for (int j : a.neighbors) {
+                if (gone[j] || a.mass + particles[j].mass > max_mass) continue;
+                double dx = particles[j].x_pos - a.x_pos;
+                double dy = particles[j].y_pos - a.y_pos;
+                double d2 = dx*dx + dy*dy;
+                if (d2 < best_dist) {
+                    best_dist = d2;
+                    best = j;
+                }
+            }
+            if (best < 0) continue;
+            Particle &b = particles[best];
+            double m = a.mass + b.mass;
+            double wa = a.mass / m, wb = b.mass / m;
+            a.x_pos = wa * a.x_pos + wb * b.x_pos;
+            a.y_pos = wa * a.y_pos + wb * b.y_pos;
+            a.previous_x_pos = wa * a.previous_x_pos + wb * b.previous_x_pos;
+            a.previous_y_pos = wa * a.previous_y_pos + wb * b.previous_y_pos;
+            a.visual_x_pos = wa * a.visual_x_pos + wb * b.visual_x_pos;
+            a.visual_y_pos = wa * a.visual_y_pos + wb * b.visual_y_pos;
+            a.x_vel = wa * a.x_vel + wb * b.x_vel;
+            a.y_vel = wa * a.y_vel + wb * b.y_vel;
+            a.x_force = wa * a.x_force + wb * b.x_force;
+            a.y_force = wa * a.y_force + wb * b.y_force;
+            a.mass = m;
+            gone[best] = 1;
+            merges++;
+        }
+        if (merges > 0) {
+            int k = 0;
+            for (int i = 0; i < n; i++) {
+                if (!gone[i]) {
+                    if (k != i) particles[k] = std::move(particles[i]);
+                    k++;
+                }
+            }
+            particles.erase(particles.begin() + k, particles.end());
+            // Neighbor indices are stale until the next step
+            for (auto &p : particles) p.neighbors.clear();
+        }
+        return merges;
+    }
+
+    // Split up to 'max_splits' merged particles (mass >= 2) in two, offset
+    // slightly along a random direction about their center of mass; a part
+    // that lands inside a solid is moved out like in set_container(). Masses
+    // are whole (merges add whole masses), and odd ones split unevenly, 3 into
+    // 2 + 1, so repeated splits always get back to unit-mass particles.
+    // Returns the number of splits.
+    int split_particles(int max_splits) {
+        static std::mt19937 gen(12345);
+        std::uniform_real_distribution<double> angle(0.0, 2.0 * M_PI);
+        const double offset = SPACING * 0.25;
+        int n = particles.size();
+        int splits = 0;
+        for (int i = 0; i < n && splits < max_splits; i++) {
+            double mass = particles[i].mass;
+            if (mass < 2.0) continue;
+            double twin_mass = std::floor(mass * 0.5);
+            double kept_mass = mass - twin_mass;
+            double a = angle(gen);
+            double dx = std::cos(a) * offset, dy = std::sin(a) * offset;
+            double tx = dx * kept_mass / mass, ty = dy * kept_mass / mass;
+            double kx = dx * twin_mass / mass, ky = dy * twin_mass / mass;
+            particles[i].mass = kept_mass;
+            Particle twin = particles[i];
+            twin.mass = twin_mass;
+            twin.neighbors.clear();
+            twin.x_pos += tx; twin.y_pos += ty;
+            twin.previous_x_pos += tx; twin.previous_y_pos += ty;
+            particles[i].x_pos -= kx; particles[i].y_pos -= ky;
+            particles[i].previous_x_pos -= kx; particles[i].previous_y_pos -= ky;
+            // Near a wall or obstacle either part may have landed in it
+            move_out_of_solids(particles[i], gen);
+            move_out_of_solids(twin, gen);
+            particles.push_back(twin);
+            splits++;
+        }
+        return splits;
+    }
+
+    // Sum of all particle masses (constant across merges and splits)
+    double total_mass() const {
+        double m = 0.0;
+        for (const auto &p : particles) m += p.mass;
+        return m;
+    }
+
+    // Return per-particle masses, in the same order as get_visual_positions()
+    std::vector<double> get_masses() const {
+        std::vector<double> masses;
+        masses.reserve(particles.size());
+        for (const auto &p : particles) {
+            masses.push_back(p.mass);
+        }
+        return masses;
     }
 
     // Return a flattened vector of visual positions (x0, y0, x1, y1, ...)
@@ -221,6 +697,68 @@ public:
         }
         return pos;
     }
+
+    // Positions blended between the last two physics steps: alpha = 0 gives
+    // the state before the last step, alpha = 1 the current one (the same as
+    // get_visual_positions()). Blended points inside a wall are projected back
+    // onto its surface. Fills 'pos' as (x0, y0, x1, y1, ...).
+    void get_interpolated_positions(double alpha, std::vector<double> &pos) const {
+        pos.resize(particles.size() * 2);
+        for (size_t i = 0; i < particles.size(); i++) {
+            const Particle &p = particles[i];
+            double x = p.previous_x_pos + alpha * (p.x_pos - p.previous_x_pos);
+            double y = p.previous_y_pos + alpha * (p.y_pos - p.previous_y_pos);
+            double nx, ny;
+            double dist = container.sample(x, y, nx, ny);
+            if (dist < 0.0) {
+                x -= dist * nx;
+                y -= dist * ny;
+            }
+            pos[2*i] = x;
+            pos[2*i + 1] = y;
+        }
+    }
+
+private:
+    // Move a particle that is inside a wall or obstacle back into the fluid:
+    // along the SDF gradient to just past the nearest surface, or, if that
+    // doesn't get it out (deep inside a solid, where the gradient is flat), to
+    // a random free spot. A moved particle comes to rest; its mass is kept.
+    void move_out_of_solids(Particle &p, std::mt19937 &gen) {
+        double nx, ny;
+        double dist = container.sample(p.x_pos, p.y_pos, nx, ny);
+        if (dist >= 0.0) return;
+        double x = p.x_pos - (dist - SOLID_PUSH_MARGIN) * nx;
+        double y = p.y_pos - (dist - SOLID_PUSH_MARGIN) * ny;
+        std::uniform_real_distribution<double> dis_x(x_min, x_max);
+        std::uniform_real_distribution<double> dis_y(y_min, y_max);
+        for (int tries = 0; tries < 1000 && container.sample(x, y, nx, ny) < 0.0; tries++) {
+            x = dis_x(gen);
+            y = dis_y(gen);
+        }
+        double mass = p.mass;
+        p = Particle(x, y);
+        p.mass = mass;
+    }
+
+    // Move particles that are inside a wall or obstacle onto its surface
+    void project_out_of_walls() {
+        double nx, ny;
+        for (auto &p : particles) {
+            double dist = container.sample(p.x_pos, p.y_pos, nx, ny);
+            if (dist < 0.0) {
+                p.x_pos -= dist * nx;
+                p.y_pos -= dist * ny;
+            }
+        }
+    }
+
+    std::vector<int> candidates;  // Scratch for calculate_density()
+    std::vector<std::pair<double, int>> near_pairs;
+    // Scratch for update_position_based()
+    std::vector<double> lambda, grad_x, grad_y, grad_sq, delta_x, delta_y, wall_gx, wall_gy;
+    std::vector<size_t> pair_start;                   // First pair of each particle
+    std::vector<double> pair_wx, pair_wy;             // Kernel gradient per pair
 };
 
 // // --- Pybind11 module definition ---
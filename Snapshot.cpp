@@ -0,0 +1,255 @@
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+#include <thread>
+#include <atomic>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+// -----------------------------------------------------------------------------
+// Simulation Snapshots
+//   A compact binary image of every particle's state so the fluid can start
+//   already settled instead of collapsing from a uniform scatter.
+//
+//   Header (56 bytes, little-endian):
+//     char[4]   "LFSN"
+//     uint32    version (3)
+//     uint32    particle count
+//     uint32    reserved (0)
+//     double[4] container xmin, xmax, ymin, ymax
+//     uint64    container hash (containerHash() in DisplayLayout.cpp)
+//   Body: per particle, float32 x, y, previous x, previous y, x vel, y vel, mass
+//   Older versions don't record which container they settled in and are
+//   ignored; the periodic save replaces them.
+// -----------------------------------------------------------------------------
+static const char SNAPSHOT_MAGIC[4] = {'L', 'F', 'S', 'N'};
+static const uint32_t SNAPSHOT_VERSION = 3;
+static const size_t SNAPSHOT_HEADER_SIZE = 56;
+static const size_t SNAPSHOT_FLOATS_PER_PARTICLE = 7;
+
+struct SnapshotHeader {
+    char magic[4];
+    uint32_t version;
+    uint32_t count;
+    uint32_t reserved;
+    double xmin, xmax, ymin, ymax;
+    uint64_t containerHash;
+};
+static_assert(sizeof(SnapshotHeader) == SNAPSHOT_HEADER_SIZE, "snapshot header must be packed");
+
+// Default snapshot file for a wall size, particle count and container, e.g.
+// "9x16_250_1f3a9c07.lfsnap" (low 32 bits of the container hash)
+std::string snapshotPathFor(int rows, int cols, int count, uint64_t containerHash) {
+    char hash[9];
+    std::snprintf(hash, sizeof(hash), "%08x", static_cast<unsigned>(containerHash & 0xFFFFFFFFu));
+    return std::to_string(rows) + "x" + std::to_string(cols) + "_" + std::to_string(count) +
+           "_" + hash + ".lfsnap";
+}
+
+// -----------------------------------------------------------------------------
+// Read-only memory map of a whole file
+// -----------------------------------------------------------------------------
+class MappedFile {
+public:
+    explicit MappedFile(const std::string& path) : data(nullptr), length(0) {
+#ifdef _WIN32
+        file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, 0, NULL);
+        mapping = NULL;
+        if (file == INVALID_HANDLE_VALUE) return;
+        LARGE_INTEGER size;
+        if (!GetFileSizeEx(file, &size) || size.QuadPart == 0) return;
+        mapping = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL);
+        if (mapping == NULL) return;
+        void* view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+        if (view == NULL) return;
+        data = static_cast<const uint8_t*>(view);
+        length = static_cast<size_t>(size.QuadPart);
+#else
+        fd = open(path.c_str(), O_RDONLY);
+        if (fd < 0) return;
+        struct stat st;
+        if (fstat(fd, &st) != 0 || st.st_size == 0) return;
+        void* view = mmap(NULL, static_cast<size_t>(st.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+        if (view == MAP_FAILED) return;
+        data = static_cast<const uint8_t*>(view);
+        length = static_cast<size_t>(st.st_size);
+#endif
+    }
+
+    ~MappedFile() {
+#ifdef _WIN32
+        if (data) UnmapViewOfFile(data);
+        if (mapping != NULL) CloseHandle(mapping);
+        if (file != INVALID_HANDLE_VALUE) CloseHandle(file);
+#else
+        if (data) munmap(const_cast<uint8_t*>(data), length);
+        if (fd >= 0) close(fd);
+#endif
+    }
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    const uint8_t* data;
+    size_t length;
+
+private:
+#ifdef _WIN32
+    HANDLE file, mapping;
+#else
+    int fd;
+#endif
+};
+
+// -----------------------------------------------------------------------------
+// Serialize the simulation state into a snapshot image (header + body).
+// -----------------------------------------------------------------------------
+void encodeSnapshot(const Simulation& sim, uint64_t containerHash, std::vector<uint8_t>& bytes) {
+    SnapshotHeader header;
+    std::memcpy(header.magic, SNAPSHOT_MAGIC, 4);
+    header.version = SNAPSHOT_VERSION;
+    header.count = static_cast<uint32_t>(sim.particles.size());
+    header.reserved = 0;
+    header.xmin = sim.x_min;
+    header.xmax = sim.x_max;
+    header.ymin = sim.y_min;
+    header.ymax = sim.y_max;
+    header.containerHash = containerHash;
+
+    bytes.resize(SNAPSHOT_HEADER_SIZE + sim.particles.size() * SNAPSHOT_FLOATS_PER_PARTICLE * sizeof(float));
+    std::memcpy(bytes.data(), &header, sizeof(header));
+    uint8_t* out = bytes.data() + SNAPSHOT_HEADER_SIZE;
+    for (const auto& p : sim.particles) {
+        float v[SNAPSHOT_FLOATS_PER_PARTICLE] = {
+            static_cast<float>(p.x_pos), static_cast<float>(p.y_pos),
+            static_cast<float>(p.previous_x_pos), static_cast<float>(p.previous_y_pos),
+            static_cast<float>(p.x_vel), static_cast<float>(p.y_vel),
+            static_cast<float>(p.mass)};
+        std::memcpy(out, v, sizeof(v));
+        out += sizeof(v);
+    }
+}
+
+// -----------------------------------------------------------------------------
+// Write a snapshot image to 'path'. The file is written next to the target
+// and renamed over it, so a crash mid-write never leaves a torn file.
+// -----------------------------------------------------------------------------
+bool writeSnapshotFile(const std::vector<uint8_t>& bytes, const std::string& path) {
+    std::string tmpPath = path + ".tmp";
+    FILE* f = std::fopen(tmpPath.c_str(), "wb");
+    if (!f) return false;
+    bool ok = std::fwrite(bytes.data(), 1, bytes.size(), f) == bytes.size();
+    ok = (std::fclose(f) == 0) && ok;
+    if (!ok) {
+        std::remove(tmpPath.c_str());
+        return false;
+    }
+#ifdef _WIN32
+    return MoveFileExA(tmpPath.c_str(), path.c_str(), MOVEFILE_REPLACE_EXISTING) != 0;
+#else
+    return std::rename(tmpPath.c_str(), path.c_str()) == 0;
+#endif
+}
+
+bool writeSnapshot(const Simulation& sim, uint64_t containerHash, const std::string& path) {
+    std::vector<uint8_t> bytes;
+    encodeSnapshot(sim, containerHash, bytes);
+    return writeSnapshotFile(bytes, path);
+}
+
+// -----------------------------------------------------------------------------
+// Periodic snapshots from the render loop. save() only copies the particle
+// state into a buffer (a few KB); the file is written and renamed on a
+// background thread, so disk stalls never hold up a frame. A save requested
+// while the previous one is still writing is skipped.
+// -----------------------------------------------------------------------------
+class SnapshotWriter {
+public:
+    SnapshotWriter() : writing(false), lastOk(true) {}
+
+    ~SnapshotWriter() {
+        if (worker.joinable()) worker.join();
+    }
+
+    // Returns false if the previous write is still running
+    bool save(const Simulation& sim, uint64_t containerHash, const std::string& path) {
+        if (writing.load()) return false;
+        if (worker.joinable()) worker.join();
+        encodeSnapshot(sim, containerHash, bytes);
+        writing = true;
+        worker = std::thread([this, path] {
+            lastOk = writeSnapshotFile(bytes, path);
+            writing = false;
+        });
+        return true;
+    }
+
+    // Whether the last finished write succeeded
+    bool lastWriteOk() const { return lastOk.load(); }
+
+private:
+    std::vector<uint8_t> bytes;
+    std::thread worker;
+    std::atomic<bool> writing;
+    std::atomic<bool> lastOk;
+};
+
+// -----------------------------------------------------------------------------
+// Replace the simulation's particles with the ones in 'path'. The snapshot must
+// have been taken in the same container (bounds and containerHash()); the
+// particle count comes from the file. Returns false (leaving 'sim' untouched)
+// if the file is missing, truncated, from another version or for another
+// container, or holds a non-finite value or a mass that is not positive.
+// -----------------------------------------------------------------------------
+bool loadSnapshot(const std::string& path, uint64_t containerHash, Simulation& sim) {
+    MappedFile file(path);
+    if (!file.data || file.length < SNAPSHOT_HEADER_SIZE) return false;
+
+    SnapshotHeader header;
+    std::memcpy(&header, file.data, sizeof(header));
+    if (std::memcmp(header.magic, SNAPSHOT_MAGIC, 4) != 0 || header.version != SNAPSHOT_VERSION) {
+        return false;
+    }
+    size_t bodyBytes = static_cast<size_t>(header.count) * SNAPSHOT_FLOATS_PER_PARTICLE * sizeof(float);
+    if (file.length != SNAPSHOT_HEADER_SIZE + bodyBytes) return false;
+
+    const double EPS = 1e-9;
+    if (std::fabs(header.xmin - sim.x_min) > EPS || std::fabs(header.xmax - sim.x_max) > EPS ||
+        std::fabs(header.ymin - sim.y_min) > EPS || std::fabs(header.ymax - sim.y_max) > EPS ||
+        header.containerHash != containerHash) {
+        return false;
+    }
+
+    const uint8_t* body = file.data + SNAPSHOT_HEADER_SIZE;
+    std::vector<Particle> particles;
+    particles.reserve(header.count);
+    for (uint32_t i = 0; i < header.count; i++) {
+        float v[SNAPSHOT_FLOATS_PER_PARTICLE];
+        std::memcpy(v, body + i * sizeof(v), sizeof(v));
+        // A damaged file: NaN/inf would spread to every neighbor, and a zero
+        // mass divides by zero in create_pressure()
+        for (float f : v) {
+            if (!std::isfinite(f)) return false;
+        }
+        if (v[6] <= 0.0f) return false;
+        Particle p(v[0], v[1]);
+        p.previous_x_pos = v[2];
+        p.previous_y_pos = v[3];
+        p.x_vel = v[4];
+        p.y_vel = v[5];
+        p.mass = v[6];
+        particles.push_back(p);
+    }
+    sim.particles.swap(particles);
+    return true;
+}
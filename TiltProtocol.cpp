@@ -0,0 +1,159 @@
+#include <cstdint>
+#include <cstddef>
+#include <cstring>
+
+// -----------------------------------------------------------------------------
+// Accelerometer Protocol (v2)
+//   Mirrored in Firmware/AccFirmware/AccFirmware.ino. All fields little-endian.
+//
+//   [0]      0xFE header
+//   [1]      protocol version (0x02)
+//   [2..3]   uint16 sequence number (wraps)
+//   [4..7]   uint32 sensor timestamp in microseconds (micros() on the Arduino)
+//   [8..11]  float tilt angle in degrees
+//   [12..15] float tilt magnitude [0..1]
+//   [16..17] CRC-16/CCITT-FALSE over bytes [1..15]
+// -----------------------------------------------------------------------------
+static const uint8_t ACCEL_HEADER = 0xFE;
+static const uint8_t ACCEL_VERSION = 0x02;
+static const int ACCEL_PACKET_SIZE = 18;
+
+struct TiltSample {
+    uint16_t seq;
+    uint32_t sensorMicros;
+    float angleDeg;
+    float magnitude;
+};
+
+struct TiltParserStats {
+    uint64_t bytesIn;          // Bytes handed to feed()
+    uint64_t bytesOverflowed;  // Bytes lost because the ring buffer was full
+    uint64_t bytesSkipped;     // Bytes discarded while hunting for a header
+    uint64_t packetsOk;        // Packets that passed the CRC
+    uint64_t packetsCorrupt;   // Header + version matched but CRC failed
+    uint64_t packetsDropped;   // Gaps in the sequence numbers of good packets
+    uint64_t packetsCoalesced; // Good packets superseded by a newer one in the same poll()
+};
+
+// CRC-16/CCITT-FALSE (poly 0x1021, init 0xFFFF), bitwise so the firmware copy
+// stays identical.
+uint16_t tiltCrc16(const uint8_t* data, size_t len) {
+    uint16_t crc = 0xFFFF;
+    for (size_t i = 0; i < len; i++) {
+        crc ^= static_cast<uint16_t>(data[i]) << 8;
+        for (int b = 0; b < 8; b++) {
+            crc = (crc & 0x8000) ? static_cast<uint16_t>((crc << 1) ^ 0x1021)
+                                 : static_cast<uint16_t>(crc << 1);
+        }
+    }
+    return crc;
+}
+
+// Serialize a sample into a full wire packet (used by tests and tooling).
+void encodeTiltPacket(const TiltSample& s, uint8_t packet[ACCEL_PACKET_SIZE]) {
+    packet[0] = ACCEL_HEADER;
+    packet[1] = ACCEL_VERSION;
+    packet[2] = static_cast<uint8_t>(s.seq & 0xFF);
+    packet[3] = static_cast<uint8_t>(s.seq >> 8);
+    for (int i = 0; i < 4; i++) {
+        packet[4 + i] = static_cast<uint8_t>(s.sensorMicros >> (8 * i));
+    }
+    std::memcpy(&packet[8], &s.angleDeg, 4);
+    std::memcpy(&packet[12], &s.magnitude, 4);
+    uint16_t crc = tiltCrc16(&packet[1], ACCEL_PACKET_SIZE - 3);
+    packet[16] = static_cast<uint8_t>(crc & 0xFF);
+    packet[17] = static_cast<uint8_t>(crc >> 8);
+}
+
+// -----------------------------------------------------------------------------
+// Incremental packet parser. Bytes from any number of reads are pushed into a
+// ring buffer with feed(); poll() consumes every complete packet and returns
+// the newest one. A header byte inside a payload can never be mistaken for a
+// packet because both the version byte and the CRC have to match; on a CRC
+// failure we slide forward one byte and keep hunting.
+// -----------------------------------------------------------------------------
+class TiltParser {
+public:
+    static const size_t RING_SIZE = 1024; // Power of two
+
+    TiltParser() : head(0), tail(0), haveSeq(false), lastSeq(0) {
+        std::memset(&statistics, 0, sizeof(statistics));
+    }
+
+    // Append bytes to the ring. If the ring is full, the oldest bytes are
+    // discarded since only the most recent tilt matters.
+    void feed(const uint8_t* data, size_t len) {
+        statistics.bytesIn += len;
+        for (size_t i = 0; i < len; i++) {
+            if (head - tail == RING_SIZE) {
+                tail++;
+                statistics.bytesOverflowed++;
+            }
+            ring[head & (RING_SIZE - 1)] = data[i];
+            head++;
+        }
+    }
+
+    // Parse all complete packets currently buffered. Returns true and writes
+    // the newest good packet to 'latest' if at least one was found.
+    bool poll(TiltSample& latest) {
+        int found = 0;
+        while (head - tail >= static_cast<size_t>(ACCEL_PACKET_SIZE)) {
+            if (at(0) != ACCEL_HEADER || at(1) != ACCEL_VERSION) {
+                tail++;
+                statistics.bytesSkipped++;
+                continue;
+            }
+
+            uint8_t packet[ACCEL_PACKET_SIZE];
+            for (int i = 0; i < ACCEL_PACKET_SIZE; i++) {
+                packet[i] = at(i);
+            }
+            uint16_t crc = static_cast<uint16_t>(packet[16] | (packet[17] << 8));
+            if (crc != tiltCrc16(&packet[1], ACCEL_PACKET_SIZE - 3)) {
+                tail++;
+                statistics.bytesSkipped++;
+                statistics.packetsCorrupt++;
+                continue;
+            }
+
+            TiltSample s;
+            s.seq = static_cast<uint16_t>(packet[2] | (packet[3] << 8));
+            s.sensorMicros = 0;
+            for (int i = 0; i < 4; i++) {
+                s.sensorMicros |= static_cast<uint32_t>(packet[4 + i]) << (8 * i);
+            }
+            std::memcpy(&s.angleDeg, &packet[8], 4);
+            std::memcpy(&s.magnitude, &packet[12], 4);
+            tail += ACCEL_PACKET_SIZE;
+
+            if (haveSeq) {
+                uint16_t gap = static_cast<uint16_t>(s.seq - lastSeq);
+                if (gap > 1) {
+                    statistics.packetsDropped += gap - 1;
+                }
+            }
+            haveSeq = true;
+            lastSeq = s.seq;
+
+            statistics.packetsOk++;
+            latest = s;
+            found++;
+        }
+        if (found > 1) {
+            statistics.packetsCoalesced += found - 1;
+        }
+        return found > 0;
+    }
+
+    const TiltParserStats& stats() const { return statistics; }
+
+private:
+    uint8_t at(size_t offset) const { return ring[(tail + offset) & (RING_SIZE - 1)]; }
+
+    uint8_t ring[RING_SIZE];
+    size_t head, tail;  // Monotonic byte counters; masked on access
+    bool haveSeq;
+    uint16_t lastSeq;
+    TiltParserStats statistics;
+};
@@ -0,0 +1,83 @@
+// Pre-bakes settled simulation snapshots so the display warm-starts instantly.
+//   g++ -O2 -std=c++17 Tools/BakeSnapshots.cpp -o BakeSnapshots
+//   ./BakeSnapshots 9x16 18x32 9x16:400 wall.layout --particles 180 wall.layout
+// Each argument is either <rows>x<cols>[:particles] (a plain rectangular
+// wall) or a layout file as passed to main.cpp --layout, whose container
+// shape and obstacles the fluid settles in. The particle count defaults to
+// the same density main.cpp uses (250 per 9×16 panel, or --particles <n>
+// for the arguments after it). Files are written to the current directory
+// under the names main.cpp looks for.
+#include <iostream>
+#include <string>
+#include <cstdio>
+#include <cstdlib>
+#include <cmath>
+
+#include "../SPHEngine.cpp"
+#include "../DisplayLayout.cpp"
+#include "../Snapshot.cpp"
+
+static const int N = 250;             // Particles per 9×16 panel, as in main.cpp
+static const int MIN_STEPS = 500;
+static const int MAX_STEPS = 20000;
+static const double SETTLED_SPEED = 1e-4; // Mean particle speed per step
+static const int SETTLED_STEPS = 200;     // ...held for this many steps
+
+static double meanSpeed(const Simulation& sim) {
+    double total = 0.0;
+    for (const auto& p : sim.particles) {
+        total += std::sqrt(p.x_vel * p.x_vel + p.y_vel * p.y_vel);
+    }
+    return sim.particles.empty() ? 0.0 : total / sim.particles.size();
+}
+
+int main(int argc, char** argv) {
+    if (argc < 2) {
+        std::cerr << "Usage: " << argv[0] << " [--particles <per panel>] <rows>x<cols>[:particles] | <layout file> ..." << std::endl;
+        return 1;
+    }
+
+    int particlesPerPanel = N;
+    for (int a = 1; a < argc; a++) {
+        std::string arg = argv[a];
+        if (arg == "--particles" && a + 1 < argc) {
+            particlesPerPanel = std::max(1, std::atoi(argv[++a]));
+            continue;
+        }
+
+        DisplayLayout layout = defaultDisplayLayout();
+        int rows = 0, cols = 0, count = 0, used = 0;
+        int fields = std::sscanf(arg.c_str(), "%dx%d%n:%d%n", &rows, &cols, &used, &count, &used);
+        if (fields >= 2 && used == static_cast<int>(arg.size()) && rows > 0 && cols > 0) {
+            layout.rows = rows;
+            layout.cols = cols;
+        } else if (!loadDisplayLayout(arg, layout)) {
+            std::cerr << "'" << arg << "' is neither <rows>x<cols>[:particles] nor a layout file" << std::endl;
+            return 1;
+        }
+        if (count <= 0) {
+            count = particlesPerPanel * (layout.rows * layout.cols) / (LED_ROWS * LED_COLS);
+        }
+
+        Simulation sim(count, layout.xMin(), layout.xMax(), layout.yMin(), layout.yMax());
+        sim.set_container(buildContainer(layout));
+
+        int step = 0, calm = 0;
+        while (step < MAX_STEPS) {
+            sim.update();
+            step++;
+            calm = (meanSpeed(sim) < SETTLED_SPEED) ? calm + 1 : 0;
+            if (step >= MIN_STEPS && calm >= SETTLED_STEPS) break;
+        }
+
+        const uint64_t hash = containerHash(layout);
+        std::string path = snapshotPathFor(layout.rows, layout.cols, count, hash);
+        if (!writeSnapshot(sim, hash, path)) {
+            std::cerr << "Failed to write " << path << std::endl;
+            return 1;
+        }
+        std::cout << path << ": " << count << " particles, " << step << " steps"
+                  << (calm >= SETTLED_STEPS ? "" : " (did not fully settle)") << std::endl;
+    }
+    return 0;
+}
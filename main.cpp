@@ -5,27 +5,43 @@
 #include <thread>
 #include <vector>
 #include <cmath>
+#include <algorithm>
+#include <functional>
+#include <cstdlib>
+#include <fstream>
 
 // -----------------------------------------------------------------------------
 // Global/Top-Level Variables
 // -----------------------------------------------------------------------------
 
-static const int LED_ROWS = 9;
-static const int LED_COLS = 16;
-static const int VAR_INTENSITY = 10; 
-static const int HALF_COLS = 8;
-
-static const double CELL_SIZE = 0.1;
+// Particles per 9×16 panel; scaled with the wall area
 static const int N = 250;
 
-// For reading accelerometer data:
-static const BYTE ACCEL_HEADER = 0xFE; 
-static const int ACCEL_PACKET_SIZE = 9;  // 1 + 8 (two floats)
+// How often the running simulation is saved for the next warm start
+static const int SNAPSHOT_PERIOD_S = 30;
+
+// Physics time per step the frame governor tries to stay under (ms)
+static const double STEP_BUDGET_MS = 16.0;
+
+// Fixed-rate physics: most steps run to catch up after a stall, per frame
+static const int MAX_CATCHUP_STEPS = 4;
+
+// Physics steps per second at dt 1: about one per frame at the serial rate,
+// the speed the engine's constants were tuned at. --physics-hz scales dt by
+// this over its rate so the fluid keeps that speed. Prototyping/
+// InterpolationBench.cpp has its own copy; keep the two equal.
+static const double REFERENCE_STEP_HZ = 80.0;
 
 // -----------------------------------------------------------------------------
-// Include Physics Engine
+// Include Physics Engine, Accelerometer Protocol and Display Layout
 // -----------------------------------------------------------------------------
 #include "SPHEngine.cpp"
+#include "TiltProtocol.cpp"
+#include "Latency.cpp"
+#include "DisplayLayout.cpp"
+#include "Rasterizer.cpp"
+#include "Snapshot.cpp"
+#include "FrameGovernor.cpp"
 
 // -----------------------------------------------------------------------------
 // Helper to open and configure the serial port on Windows.
@@ -83,198 +99,412 @@ HANDLE openSerialPort(const char* portName, DWORD baudRate = CBR_115200) {
 }
 
 // -----------------------------------------------------------------------------
-// Try to read a 9-byte packet: [0xFE][float angle][float magnitude]
-// Returns true if we got a full packet. On success, outputs angle & magnitude.
+// Drain the accelerometer port into the packet parser (non-blocking).
+// Returns true if at least one new packet arrived; 'sample' gets the newest.
+// Partial packets stay buffered in the parser until the next call.
 // -----------------------------------------------------------------------------
-bool readTiltData(HANDLE hSerial, float &angleDeg, float &magnitude) {
+bool readTiltData(HANDLE hSerial, TiltParser &parser, TiltSample &sample) {
     COMSTAT stat;
     DWORD errors;
     ClearCommError(hSerial, &errors, &stat);
 
-    DWORD bytesAvailable = stat.cbInQue;
-    if (bytesAvailable < ACCEL_PACKET_SIZE) {
-        return false; // Not enough data
-    }
-
-    // Read all available bytes (up to a safe max)
     const DWORD MAX_READ = 1024;
     uint8_t buffer[MAX_READ];
-    DWORD bytesToRead = (bytesAvailable > MAX_READ) ? MAX_READ : bytesAvailable;
-    DWORD bytesRead = 0;
-
-    if (!ReadFile(hSerial, buffer, bytesToRead, &bytesRead, NULL) || bytesRead == 0) {
-        return false;
-    }
-
-    // Search for the last valid packet (from end to start)
-    for (int i = bytesRead - ACCEL_PACKET_SIZE; i >= 0; --i) {
-        if (buffer[i] == ACCEL_HEADER) {
-            // Found a possible packet
-            union FloatBytes {
-                float f;
-                uint8_t b[4];
-            } angleData, magData;
-
-            for (int j = 0; j < 4; ++j)
-                angleData.b[j] = buffer[i + 1 + j];
-            for (int j = 0; j < 4; ++j)
-                magData.b[j] = buffer[i + 5 + j];
-
-            angleDeg = angleData.f;
-            magnitude = magData.f;
-            return true;
+    DWORD bytesAvailable = stat.cbInQue;
+    while (bytesAvailable > 0) {
+        DWORD bytesToRead = (bytesAvailable > MAX_READ) ? MAX_READ : bytesAvailable;
+        DWORD bytesRead = 0;
+        if (!ReadFile(hSerial, buffer, bytesToRead, &bytesRead, NULL) || bytesRead == 0) {
+            break;
         }
+        parser.feed(buffer, bytesRead);
+        bytesAvailable -= bytesRead;
     }
 
-    return false; // No valid packet found
+    return parser.poll(sample);
 }
 
 // -----------------------------------------------------------------------------
-// HashGrid for converting SPH positions -> LED brightness
+// Send one tile's frame in binary: [0xFF] + rows*cols brightness bytes.
+// The panel buffers it until the commit byte arrives.
 // -----------------------------------------------------------------------------
-void hashGrid(const std::vector<double>& positions,
-              unsigned char ledFrame[LED_ROWS][LED_COLS])
-{
-    // 1) Clear out ledFrame
-    for (int r = 0; r < LED_ROWS; r++) {
-        for (int c = 0; c < LED_COLS; c++) {
-            ledFrame[r][c] = 0;
-        }
-    }
-
-    // 2) Internal accumulators
-    int counts[LED_ROWS][LED_COLS];
-    for (int r = 0; r < LED_ROWS; r++) {
-        for (int c = 0; c < LED_COLS; c++) {
-            counts[r][c] = 0;
-        }
-    }
-
-    // 3) For each particle
-    for (size_t i = 0; i + 1 < positions.size(); i += 2) {
-        double x = positions[i];
-        double y = positions[i+1];
-
-        int x_index = static_cast<int>((x + SIM_W) / CELL_SIZE);
-        int y_index = static_cast<int>(y / CELL_SIZE);
+void sendFrameToArduino(HANDLE hSerial, const PanelTile &tile, const unsigned char* ledFrame,
+                        std::vector<unsigned char> &framePacket) {
+    static const BYTE HEADER = 0xFF;
+    const int totalBytes = 1 + tile.rows * tile.cols; // 145 for a 9×16 panel
 
-        if (x_index >= 0 && x_index < LED_COLS &&
-            y_index >= 0 && y_index < LED_ROWS)
-        {
-            counts[y_index][x_index]++;
-        }
-    }
+    framePacket.resize(totalBytes);
+    framePacket[0] = HEADER;
+    std::copy(ledFrame, ledFrame + tile.rows * tile.cols, framePacket.begin() + 1);
 
-    // 4) Convert counts to brightness
-    for (int r = 0; r < LED_ROWS; r++) {
-        for (int c = 0; c < LED_COLS; c++) {
-            int countVal = counts[r][c];
-            if (countVal >= VAR_INTENSITY) {
-                countVal = VAR_INTENSITY - 1;
-            }
-            int brightness = static_cast<int>(countVal * (255.0 / (VAR_INTENSITY - 1)));
-            ledFrame[r][c] = static_cast<unsigned char>(brightness);
-        }
-    }
+    DWORD bytesWritten;
+    WriteFile(hSerial, framePacket.data(), totalBytes, &bytesWritten, NULL);
 }
 
 // -----------------------------------------------------------------------------
-// Send a 9×16 LED frame in binary: [0xFF] + 144 brightness bytes
+// Tell a panel to show the frame it last received: [0xFD]
 // -----------------------------------------------------------------------------
-void sendFrameToArduino(HANDLE hSerial, const unsigned char ledFrame[LED_ROWS][LED_COLS]) {
-    static const BYTE HEADER = 0xFF;
-    static const int TOTAL_BYTES = 1 + (LED_ROWS * LED_COLS); // 145
-
-    unsigned char framePacket[TOTAL_BYTES];
-    framePacket[0] = HEADER;
-
-    int index = 1;
-    for (int r = 0; r < LED_ROWS; r++) {
-        for (int c = 0; c < LED_COLS; c++) {
-            framePacket[index++] = ledFrame[r][c];
-        }
-    }
-
+void sendCommitToArduino(HANDLE hSerial) {
+    static const BYTE COMMIT = 0xFD;
     DWORD bytesWritten;
-    WriteFile(hSerial, framePacket, TOTAL_BYTES, &bytesWritten, NULL);
+    WriteFile(hSerial, &COMMIT, 1, &bytesWritten, NULL);
 }
 
 // -----------------------------------------------------------------------------
 // Main
 // -----------------------------------------------------------------------------
-int main() {
+int main(int argc, char** argv) {
+    // Optional: extrapolate gravity to the expected display time
+    bool usePrediction = false;
+    // Optional: multi-panel wall (defaults to one 9×16 panel on COM6)
+    DisplayLayout layout = defaultDisplayLayout();
+    // Optional: snapshot file (defaults to one per wall size and particle count)
+    std::string snapshotPath;
+    // Optional: particle count per 9×16 panel and physics budget per step
+    int particlesPerPanel = N;
+    double stepBudgetMs = STEP_BUDGET_MS;
+    // Optional: fixed physics rate (Hz) with frames interpolated in between,
+    // and dt = REFERENCE_STEP_HZ / rate; 0 steps once per new tilt packet and
+    // shows the latest state
+    double physicsHz = 0.0;
+    // Optional: kernel-density rasterizer instead of the hash grid
+    bool useKernelDensity = false;
+    // Optional: solver backend, constraint iterations and step length
+    Solver solver = Solver::DoubleDensity;
+    int solverIterations = PBF_ITERATIONS;
+    double stepDt = 1.0;
+    bool stepDtGiven = false;
+    // Optional: log the gravity angle of every physics step (for Prototyping/SolverCompare.cpp)
+    std::string tiltTracePath;
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "--predict") {
+            usePrediction = true;
+        } else if (arg == "--layout" && i + 1 < argc) {
+            if (!loadDisplayLayout(argv[++i], layout)) {
+                return 1;
+            }
+        } else if (arg == "--snapshot" && i + 1 < argc) {
+            snapshotPath = argv[++i];
+        } else if (arg == "--particles" && i + 1 < argc) {
+            particlesPerPanel = std::max(1, std::atoi(argv[++i]));
+        } else if (arg == "--budget" && i + 1 < argc) {
+            stepBudgetMs = std::atof(argv[++i]);
+            if (stepBudgetMs <= 0.0) {
+                std::cerr << "--budget must be positive" << std::endl;
+                return 1;
+            }
+        } else if (arg == "--physics-hz" && i + 1 < argc) {
+            physicsHz = std::max(0.0, std::atof(argv[++i]));
+        } else if (arg == "--raster" && i + 1 < argc) {
+            std::string mode = argv[++i];
+            if (mode != "hash" && mode != "kde") {
+                std::cerr << "--raster must be hash or kde" << std::endl;
+                return 1;
+            }
+            useKernelDensity = (mode == "kde");
+        } else if (arg == "--solver" && i + 1 < argc) {
+            std::string name = argv[++i];
+            if (name != "dd" && name != "pbf") {
+                std::cerr << "--solver must be dd or pbf" << std::endl;
+                return 1;
+            }
+            solver = (name == "pbf") ? Solver::PositionBased : Solver::DoubleDensity;
+        } else if (arg == "--iterations" && i + 1 < argc) {
+            solverIterations = std::max(1, std::atoi(argv[++i]));
+        } else if (arg == "--dt" && i + 1 < argc) {
+            stepDt = std::atof(argv[++i]);
+            stepDtGiven = true;
+            if (stepDt <= 0.0) {
+                std::cerr << "--dt must be positive" << std::endl;
+                return 1;
+            }
+        } else if (arg == "--record-tilt" && i + 1 < argc) {
+            tiltTracePath = argv[++i];
+        }
+    }
+    if (physicsHz > 0.0) {
+        if (stepDtGiven) {
+            std::cerr << "--dt and --physics-hz both set the step length; pass only one" << std::endl;
+            return 1;
+        }
+        stepDt = REFERENCE_STEP_HZ / physicsHz;
+        if (solver == Solver::DoubleDensity && stepDt > 1.0) {
+            std::cerr << "Double-density relaxation diverges above dt 1, so --physics-hz must be at least "
+                      << REFERENCE_STEP_HZ << " (or use --solver pbf)" << std::endl;
+            return 1;
+        }
+    }
+
     // 1) Open COM ports
-    // COM port for graphics
-    const char* portNameGPU = "COM6";  // Adjust as needed
-    HANDLE hSerialGPU = openSerialPort(portNameGPU, CBR_115200);
-    if (hSerialGPU == INVALID_HANDLE_VALUE) {
-        return 1;
+    // One COM port per panel for graphics
+    std::vector<HANDLE> gpuPorts;
+    for (size_t t = 0; t < layout.tiles.size(); t++) {
+        HANDLE hSerialGPU = openSerialPort(layout.tiles[t].port.c_str(), CBR_115200);
+        if (hSerialGPU == INVALID_HANDLE_VALUE) {
+            return 1;
+        }
+        gpuPorts.push_back(hSerialGPU);
     }
 
     // COM port for accl
-    const char* portNameAcc = "COM7";  // Adjust as needed
-    HANDLE hSerialAcc = openSerialPort(portNameAcc, CBR_115200);
+    HANDLE hSerialAcc = openSerialPort(layout.accelPort.c_str(), CBR_115200);
     if (hSerialAcc == INVALID_HANDLE_VALUE) {
         return 1;
     }
 
-    // 2) Create SPH simulation
-    Simulation sim(N, -SIM_W, SIM_W, BOTTOM, TOP);
+    // 2) Create SPH simulation over the whole wall
+    int particleCount = particlesPerPanel * (layout.rows * layout.cols) / (LED_ROWS * LED_COLS);
+    Simulation sim(particleCount, layout.xMin(), layout.xMax(), layout.yMin(), layout.yMax());
+
+    // Enclosure shape and obstacles (moves any particle that starts inside one)
+    sim.set_container(buildContainer(layout));
+    const uint64_t layoutHash = containerHash(layout);
+
+    // Warm start from a snapshot settled in this same container, if there is
+    // one (see Tools/BakeSnapshots.cpp)
+    if (snapshotPath.empty()) {
+        snapshotPath = snapshotPathFor(layout.rows, layout.cols, particleCount, layoutHash);
+    }
+    if (loadSnapshot(snapshotPath, layoutHash, sim)) {
+        std::cout << "Warm start from " << snapshotPath << std::endl;
+    } else {
+        std::cout << "No usable snapshot at " << snapshotPath << ", starting from random particles" << std::endl;
+    }
+    SnapshotWriter snapshotWriter;
+    auto lastSnapshotTime = std::chrono::steady_clock::now();
+
+    sim.solver = solver;
+    sim.solver_iterations = solverIterations;
+    sim.dt = stepDt;
+
+    std::ofstream tiltTrace;
+    if (!tiltTracePath.empty()) {
+        tiltTrace.open(tiltTracePath.c_str());
+        if (!tiltTrace) {
+            std::cerr << "Cannot write tilt trace " << tiltTracePath << std::endl;
+            return 1;
+        }
+        tiltTrace << "# seconds gravity_angle_rad dt (one line per physics step)\n";
+    }
+    const auto traceStart = std::chrono::steady_clock::now();
+
+    // Sheds viscosity, neighbors and finally particles when steps run long
+    FrameGovernor governor(stepBudgetMs, particleCount);
+
+    // 3) Per-tile frame buffers, rasterized and sent in parallel
+    std::vector<std::vector<unsigned char>> tileFrames(layout.tiles.size());
+    std::vector<std::vector<unsigned char>> tilePackets(layout.tiles.size());
+    for (size_t t = 0; t < layout.tiles.size(); t++) {
+        tileFrames[t].resize(layout.tiles[t].rows * layout.tiles[t].cols);
+    }
+    TileWorkers tileWorkers(layout.tiles.size());
+    std::vector<double> positions;
+    std::vector<double> masses;
+    std::vector<double> ledCounts;
+    NeighborGrid displayGrid(layout.xMin(), layout.xMax(), layout.yMin(), layout.yMax(), RADIUS);
+    std::function<void(size_t)> rasterTile = [&](size_t t) {
+        if (useKernelDensity) {
+            kernelDensity(positions, masses, displayGrid, layout, layout.tiles[t], tileFrames[t].data());
+        } else {
+            hashGrid(ledCounts, layout, layout.tiles[t], tileFrames[t].data());
+        }
+    };
+    std::function<void(size_t)> sendTile = [&](size_t t) {
+        sendFrameToArduino(gpuPorts[t], layout.tiles[t], tileFrames[t].data(), tilePackets[t]);
+    };
 
-    // 3) Frame buffer
-    static unsigned char ledFrame[LED_ROWS][LED_COLS];
+    std::cout << "Driving " << layout.tiles.size() << " panel(s), " << layout.rows << "x"
+              << layout.cols << " LEDs, " << particleCount << " particles\n";
 
+    if (physicsHz > 0.0) {
+        std::cout << "Physics at " << physicsHz << " Hz, frames interpolated\n";
+    }
+    std::cout << (solver == Solver::PositionBased ? "Position-based solver, " : "Double-density solver, ")
+              << "dt " << stepDt << "\n";
     std::cout << "Starting simulation + serial with Arduino(s)...\n";
 
     // We'll store the tilt angle (deg) and magnitude from Arduino
     float tiltAngleDeg  = 0.0f;
     float tiltMagnitude = 0.0f;
+    TiltParser tiltParser;
+    TiltSample tiltSample;
+
+    // Latency instrumentation
+    SensorClock sensorClock;
+    GravityPredictor predictor;
+    LatencyHistogram motionToPhoton;  // Tilt sampled -> frame written to the GPU port
+    LatencyHistogram tiltTransport;   // Tilt sampled -> parsed on the PC
+    LatencyHistogram framePipeline;   // Physics start -> frame written
+    FrameStamp stamp;
+    bool haveTilt = false;
+    double pipelineEmaMicros = 0.0;
 
     // For FPS logging
     int frameCount = 0;
     auto lastTime = std::chrono::steady_clock::now();
     double fps = 0.0;
+    double m2pP50 = 0.0, m2pP99 = 0.0, transportP50 = 0.0, pipelineP50 = 0.0;
+
+    // Fixed-rate physics accumulator (only used with --physics-hz)
+    const double physicsPeriodS = (physicsHz > 0.0) ? 1.0 / physicsHz : 0.0;
+    double physicsAccumS = 0.0;
+    auto lastFrameTime = std::chrono::steady_clock::now();
+    int stepCount = 0;
+    double stepsPerSec = 0.0;
+
+    // Gravity direction, optionally extrapolated to when this frame
+    // should land on the LEDs
+    auto gravityAngleRad = [&]() {
+        double angleDeg = tiltAngleDeg;
+        if (usePrediction) {
+            LatencyTime displayAt = stamp.simStart +
+                std::chrono::microseconds(static_cast<long long>(pipelineEmaMicros));
+            angleDeg = predictor.predict(displayAt);
+        }
+        // Convert angle to radians, magnitude in [0..1]
+        return ((angleDeg) * -1 - 90)* M_PI / 180.0;
+    };
+    auto stepPhysics = [&]() {
+        LatencyTime stepStart = LatencyClock::now();
+        double angleRad = gravityAngleRad();
+        if (tiltTrace.is_open()) {
+            tiltTrace << std::chrono::duration<double>(stepStart - traceStart).count()
+                      << " " << angleRad << " " << sim.dt << "\n";
+        }
+        sim.update(G_MAG, angleRad);
+        governor.update(microsBetween(stepStart, LatencyClock::now()) / 1000.0, sim);
+        stepCount++;
+    };
 
     while (true) {
         // a) Attempt to read accelerometer data (non-blocking)
-        if (readTiltData(hSerialAcc, tiltAngleDeg, tiltMagnitude)) {
+        stamp.simStart = LatencyClock::now();
+        bool newTilt = readTiltData(hSerialAcc, tiltParser, tiltSample);
+        if (newTilt) {
+            tiltAngleDeg  = tiltSample.angleDeg;
+            tiltMagnitude = tiltSample.magnitude;
             // std::cout << "\rTiltAngle=" << tiltAngleDeg 
             // << " deg  TiltMag=" << tiltMagnitude 
             // << "     " << std::flush;
-            // If we got new data, convert angle to radians, magnitude in [0..1]
-            double angleRad = ((tiltAngleDeg) * -1 - 90)* M_PI / 180.0;
-            double dynGmag  = tiltMagnitude * G_MAG; 
-            sim.update(G_MAG, angleRad);
+            stamp.tilt.received = stamp.simStart;
+            stamp.tilt.sampled  = sensorClock.toHost(tiltSample.sensorMicros, stamp.tilt.received);
+            tiltTransport.record(microsBetween(stamp.tilt.sampled, stamp.tilt.received));
+            predictor.addSample(stamp.tilt.sampled, tiltAngleDeg);
+            haveTilt = true;
+        }
+
+        auto frameTime = std::chrono::steady_clock::now();
+        double alpha = 1.0;
+        if (physicsPeriodS == 0.0) {
+            // One step per new tilt packet
+            if (newTilt) {
+                stepPhysics();
+            }
+            //  else {
+            //     // If no new data, we can keep last tilt or fallback to default
+            //     sim.update(G_MAG, G_ANG);
+            // }
+        } else if (haveTilt) {
+            // Fixed rate: run the steps that fell due since the last frame,
+            // then show the point between the last two states this frame is at
+            physicsAccumS += std::chrono::duration<double>(frameTime - lastFrameTime).count();
+            int steps = 0;
+            while (physicsAccumS >= physicsPeriodS && steps < MAX_CATCHUP_STEPS) {
+                stepPhysics();
+                physicsAccumS -= physicsPeriodS;
+                steps++;
+            }
+            if (steps == MAX_CATCHUP_STEPS && physicsAccumS >= physicsPeriodS) {
+                physicsAccumS = 0.0;  // Too far behind: drop the backlog
+            }
+            alpha = physicsAccumS / physicsPeriodS;
+        }
+        lastFrameTime = frameTime;
+        stamp.simDone = LatencyClock::now();
+
+        // b) Get updated particle positions (blended between steps at a
+        //    fixed physics rate)
+        if (physicsPeriodS == 0.0) {
+            positions = sim.get_visual_positions();
+        } else {
+            sim.get_interpolated_positions(alpha, positions);
+        }
+        masses = sim.get_masses();
+        if (useKernelDensity) {
+            displayGrid.build(positions);
+        } else {
+            binParticles(positions, masses, layout, ledCounts);
         }
-        
-        //  else {
-        //     // If no new data, we can keep last tilt or fallback to default
-        //     sim.update(G_MAG, G_ANG);
-        // }
 
-        // b) Get updated particle positions
-        std::vector<double> positions = sim.get_visual_positions();
+        // c) Convert to brightness, one tile per worker
+        tileWorkers.run(rasterTile);
+        stamp.rasterDone = LatencyClock::now();
 
-        // c) Convert to 9×16 brightness
-        hashGrid(positions, ledFrame);
+        // d) Send every tile's frame, then commit them together so the
+        //    panels swap at the same moment instead of tearing
+        tileWorkers.run(sendTile);
+        for (size_t t = 0; t < gpuPorts.size(); t++) {
+            sendCommitToArduino(gpuPorts[t]);
+        }
+        stamp.sendDone = LatencyClock::now();
 
-        // d) Send to Arduino
-        sendFrameToArduino(hSerialGPU, ledFrame);
+        double pipelineMicros = microsBetween(stamp.simStart, stamp.sendDone);
+        framePipeline.record(pipelineMicros);
+        pipelineEmaMicros += 0.1 * (pipelineMicros - pipelineEmaMicros);
+        if (haveTilt) {
+            motionToPhoton.record(microsBetween(stamp.tilt.sampled, stamp.sendDone));
+        }
 
         // e) FPS logging
         frameCount++;
         auto now = std::chrono::steady_clock::now();
+
+        // f) Periodic snapshot for the next warm start
+        if (now - lastSnapshotTime >= std::chrono::seconds(SNAPSHOT_PERIOD_S)) {
+            // Written on a background thread; only the copy happens here
+            if (!snapshotWriter.lastWriteOk()) {
+                std::cerr << "\nFailed to write snapshot " << snapshotPath << std::endl;
+            }
+            snapshotWriter.save(sim, layoutHash, snapshotPath);
+            lastSnapshotTime = now;
+        }
+
         auto elapsedMs = std::chrono::duration_cast<std::chrono::milliseconds>(now - lastTime).count();
         if (elapsedMs >= 1000) {
             fps = frameCount / (elapsedMs / 1000.0);
+            stepsPerSec = stepCount / (elapsedMs / 1000.0);
             frameCount = 0;
+            stepCount = 0;
             lastTime = now;
+            // Report the last second's latency percentiles, then start over
+            m2pP50 = motionToPhoton.percentile(50) / 1000.0;
+            m2pP99 = motionToPhoton.percentile(99) / 1000.0;
+            transportP50 = tiltTransport.percentile(50) / 1000.0;
+            pipelineP50 = framePipeline.percentile(50) / 1000.0;
+            motionToPhoton.reset();
+            tiltTransport.reset();
+            framePipeline.reset();
         }
-        std::cout << "\rFPS: " << fps << "   TiltAngle=" << tiltAngleDeg 
-                  << " deg  TiltMag=" << tiltMagnitude << "     " << std::flush;
+        const TiltParserStats &tiltStats = tiltParser.stats();
+        const GovernorMetrics &gov = governor.metrics();
+        std::cout << "\rFPS: " << fps << " (" << stepsPerSec << " steps/s)   TiltAngle=" << tiltAngleDeg 
+                  << " deg  TiltMag=" << tiltMagnitude
+                  << "  Pkts ok/drop/bad/coal=" << tiltStats.packetsOk
+                  << "/" << tiltStats.packetsDropped
+                  << "/" << tiltStats.packetsCorrupt
+                  << "/" << tiltStats.packetsCoalesced
+                  << "  M2P p50/p99=" << m2pP50 << "/" << m2pP99 << "ms"
+                  << " (link " << transportP50 << "ms, frame " << pipelineP50 << "ms)"
+                  << (usePrediction ? "  pred" : "") << (useKernelDensity ? "  kde" : "")
+                  << "  Gov L" << gov.level << " " << gov.particles << "p "
+                  << gov.stepMsEma << "/" << gov.budgetMs << "ms"
+                  << " m/s=" << gov.merges << "/" << gov.splits << "     " << std::flush;
     }
 
-    CloseHandle(hSerialGPU);
+    for (size_t t = 0; t < gpuPorts.size(); t++) {
+        CloseHandle(gpuPorts[t]);
+    }
     CloseHandle(hSerialAcc);
     return 0;
 }